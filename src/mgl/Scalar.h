@@ -19,6 +19,17 @@ typedef double Scalar;
 #define SCALAR_MAX std::numeric_limits<double>::max()
 #define SCALAR_MIN -SCALAR_MAX
 
+//////////
+// StorageScalar: type used to store bulk coordinate data such as grid ranges.
+// Arithmetic is still done in Scalar. Build with MGL_FLOAT_STORAGE to store
+// single precision floats, halving the memory those tables take up.
+///////////
+#ifdef MGL_FLOAT_STORAGE
+typedef float StorageScalar;
+#else
+typedef Scalar StorageScalar;
+#endif
+
 namespace libthing {
 /** (t)olerance (equals)
  * @returns true if two Scalar values are approximately the same using tolerance
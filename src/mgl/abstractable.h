@@ -207,6 +207,14 @@ protected:
             progress->tick();
         }
     }
+    /// tick from inside a parallel loop, one thread at a time
+    void tickShared()
+    {
+#ifdef OMPFF
+#pragma omp critical (progressiveTick)
+#endif
+        tick();
+    }
 
 };
 
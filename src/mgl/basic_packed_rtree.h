@@ -0,0 +1,261 @@
+/*
+ * File:   basic_packed_rtree.h
+ * Author: Dev
+ *
+ * A bulk loaded rtree, rebuilt as a whole rather than updated in place
+ */
+
+#ifndef MGL_BASIC_PACKED_RTREE_H
+#define	MGL_BASIC_PACKED_RTREE_H
+
+#include "spacial_data.h"
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <cmath>
+
+namespace mgl {
+
+/*
+ basic_packed_rtree implements the interface for a spacial index, the
+ same one as basic_boxlist. See basic_boxlist.h for how to make a type
+ searchable and for what search(collection, filter) expects.
+
+ Values are packed into leaves of up to C values by sort tile recursive
+ packing: sorted into vertical slabs by the x of their centers, then
+ into leaves by y within each slab. Each level above groups C nodes of
+ the level below, up to a single root. A search only descends into nodes
+ whose bounding box passes the filter, so the filter must pass a box
+ whenever it passes some box inside it. BBoxFilter and LineSegmentFilter
+ both do.
+
+ Values inserted since the tree was last packed wait in a list that
+ every search tests one by one. The next search packs the tree again
+ once that list grows past an eighth of the packed values. Inserting
+ everything before searching costs a single packing, and inserts mixed
+ with searches cost O(log n) each on average.
+
+ Search results come in the order the values were inserted, as from
+ basic_boxlist, so code that looks only at the first result sees the
+ same value with either index.
+
+ Interface methods, besides those of basic_boxlist:
+
+ template <typename COLLECTION>
+ void searchNear(COLLECTION& result, const AABBox& around, Scalar distance);
+     //values whose bounding box comes within distance of around
+
+ Iteration over the contents is not provided.
+ */
+
+template <typename T, size_t C = 8>
+class basic_packed_rtree {
+public:
+    typedef T value_type;
+
+    basic_packed_rtree() : nextOrder(0), packedCount(0) {}
+
+    /*!Insert a value into the spacial index
+     @value: a const reference of what should be inserted.
+     a copy of this will be stored.*/
+    void insert(const value_type& value) {
+        entries.push_back(entry(value, nextOrder++));
+    }
+    /**
+     @brief erase all elements that compare equal to @a value
+     @param COMPARE a comparator used to test for equality
+     Note! We assume that for two things to be equal, their bounding boxes
+     must overlap!
+     @param value erase all things that compare to this
+     @return number of elements erased
+     */
+    template <typename COMPARE>
+    size_t erase(const value_type& value, const COMPARE& comp = COMPARE()) {
+        std::vector<size_t> found;
+        collect(found, BBoxFilter(to_bbox<value_type>::bound(value)));
+        size_t ret = 0;
+        for(std::vector<size_t>::const_iterator iter = found.begin();
+                iter != found.end();
+                ++iter) {
+            if(comp(value, entries[*iter].value)) {
+                entries[*iter].live = false;
+                ++ret;
+            }
+        }
+        return ret;
+    }
+    /**
+     @brief erase all elements that compare equal to @a value
+     @param value erase all things that compare to this
+     @return number of elements erased
+     */
+    size_t erase(const value_type& value) {
+        return erase< std::equal_to<value_type> >(value);
+    }
+    /*!Search for values that meet criteria of filt.filter(AABBox)
+     @result: Object supporting push_back(...) where output is placed
+     @filter: object supporting filter(...) that defines the criteria
+     Copies of values that pass the filter are placed in result, in the
+     order they were inserted.*/
+    template <typename COLLECTION, typename FILTER>
+    void search(COLLECTION& result, const FILTER& filt) const {
+        std::vector<size_t> found;
+        collect(found, filt);
+        for(std::vector<size_t>::const_iterator iter = found.begin();
+                iter != found.end();
+                ++iter)
+            result.push_back(entries[*iter].value);
+    }
+    /*!Search for values whose bounding box comes within distance of around
+     @result: Object supporting push_back(...) where output is placed
+     @around: the box to look around
+     @distance: how far from around in x and in y to look*/
+    template <typename COLLECTION>
+    void searchNear(COLLECTION& result, const AABBox& around,
+            Scalar distance) const {
+        search(result, BBoxFilter(around.adjusted(
+                Point2Type(-distance, -distance),
+                Point2Type(distance, distance))));
+    }
+    /*!Swap contents of this object with that of another
+     @other: The object with which to swap contents*/
+    void swap(basic_packed_rtree& other) {
+        entries.swap(other.entries);
+        levels.swap(other.levels);
+        std::swap(nextOrder, other.nextOrder);
+        std::swap(packedCount, other.packedCount);
+    }
+
+private:
+    struct entry {
+        entry(const value_type& val, size_t ord)
+                : value(val), bounds(to_bbox<value_type>::bound(val)),
+                order(ord), live(true) {}
+        value_type value;
+        AABBox bounds;
+        size_t order;   //when it was inserted
+        bool live;      //false once erased
+    };
+    struct dead {
+        bool operator()(const entry& e) const { return !e.live; }
+    };
+    struct center_x_less {
+        bool operator()(const entry& a, const entry& b) const {
+            return a.bounds.left() + a.bounds.right() <
+                    b.bounds.left() + b.bounds.right();
+        }
+    };
+    struct center_y_less {
+        bool operator()(const entry& a, const entry& b) const {
+            return a.bounds.bottom() + a.bounds.top() <
+                    b.bounds.bottom() + b.bounds.top();
+        }
+    };
+    /*!Orders indexes into entries by when the values were inserted*/
+    struct order_less {
+        order_less(const std::vector<entry>& ent) : entries(ent) {}
+        bool operator()(size_t a, size_t b) const {
+            return entries[a].order < entries[b].order;
+        }
+        const std::vector<entry>& entries;
+    };
+    typedef std::vector<AABBox> level;
+
+    /*!Pack the tree again if too many values wait outside it*/
+    void refresh() const {
+        size_t waiting = entries.size() - packedCount;
+        if(waiting > C + packedCount / 8)
+            pack();
+    }
+    void pack() const {
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                dead()), entries.end());
+        levels.clear();
+        packedCount = entries.size();
+        if(entries.empty())
+            return;
+        //vertical slabs of about sqrt(leaves) leaves each
+        size_t leafCount = (entries.size() + C - 1) / C;
+        size_t slabLeaves = static_cast<size_t>(
+                std::ceil(std::sqrt(static_cast<double>(leafCount))));
+        size_t slabSize = slabLeaves * C;
+        std::sort(entries.begin(), entries.end(), center_x_less());
+        for(size_t slab = 0; slab < entries.size(); slab += slabSize) {
+            std::sort(entries.begin() + slab,
+                    entries.begin() + std::min(slab + slabSize,
+                    entries.size()),
+                    center_y_less());
+        }
+        levels.push_back(level(leafCount));
+        for(size_t leaf = 0; leaf < leafCount; ++leaf) {
+            size_t first = leaf * C;
+            size_t last = std::min(first + C, entries.size());
+            AABBox& box = levels.back()[leaf];
+            box = entries[first].bounds;
+            for(size_t child = first + 1; child < last; ++child)
+                box.expandTo(entries[child].bounds);
+        }
+        while(levels.back().size() > 1) {
+            const level below = levels.back();
+            levels.push_back(level((below.size() + C - 1) / C));
+            for(size_t node = 0; node < levels.back().size(); ++node) {
+                size_t first = node * C;
+                size_t last = std::min(first + C, below.size());
+                AABBox& box = levels.back()[node];
+                box = below[first];
+                for(size_t child = first + 1; child < last; ++child)
+                    box.expandTo(below[child]);
+            }
+        }
+    }
+    /*!Indexes into entries of the live values passing filt, in the order
+     they were inserted*/
+    template <typename FILTER>
+    void collect(std::vector<size_t>& found, const FILTER& filt) const {
+        refresh();
+        if(!levels.empty() && filt.filter(levels.back().front())) {
+            //nodes still to visit, as (level, node) pairs
+            std::vector<std::pair<size_t, size_t> > pending;
+            pending.push_back(std::make_pair(levels.size() - 1, size_t(0)));
+            while(!pending.empty()) {
+                size_t depth = pending.back().first;
+                size_t first = pending.back().second * C;
+                pending.pop_back();
+                if(depth == 0) {
+                    size_t last = std::min(first + C, packedCount);
+                    for(size_t child = first; child < last; ++child) {
+                        if(entries[child].live &&
+                                filt.filter(entries[child].bounds))
+                            found.push_back(child);
+                    }
+                    continue;
+                }
+                const level& below = levels[depth - 1];
+                size_t last = std::min(first + C, below.size());
+                for(size_t child = first; child < last; ++child) {
+                    if(filt.filter(below[child]))
+                        pending.push_back(std::make_pair(depth - 1, child));
+                }
+            }
+        }
+        for(size_t waiting = packedCount; waiting < entries.size();
+                ++waiting) {
+            if(entries[waiting].live && filt.filter(entries[waiting].bounds))
+                found.push_back(waiting);
+        }
+        if(found.size() > 1)
+            std::sort(found.begin(), found.end(), order_less(entries));
+    }
+
+    //packing happens lazily from const searches
+    mutable std::vector<entry> entries;   //packed values, then waiting ones
+    mutable std::vector<level> levels;    //leaf boxes first, root last
+    size_t nextOrder;
+    mutable size_t packedCount;
+};
+
+}
+
+#endif	/* MGL_BASIC_PACKED_RTREE_H */
+
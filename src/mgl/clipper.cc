@@ -55,6 +55,47 @@ static double const pi = 3.141592653589793238;
 enum Direction { dRightToLeft, dLeftToRight };
 enum RangeTest { rtLo, rtHi, rtError };
 
+//free lists of pooled records by size in units of POOL_GRAIN bytes
+static size_t const POOL_GRAIN = sizeof(double);
+static size_t const POOL_CLASSES = 16;
+static void* freeRecords[POOL_CLASSES];
+#ifdef OMPFF
+#pragma omp threadprivate(freeRecords)
+#endif
+
+void* PooledRecord::operator new(size_t size)
+{
+  size_t sizeClass = (size + POOL_GRAIN - 1) / POOL_GRAIN;
+  if (sizeClass >= POOL_CLASSES) return ::operator new(size);
+  void* result = freeRecords[sizeClass];
+  if (!result) return ::operator new(sizeClass * POOL_GRAIN);
+  freeRecords[sizeClass] = *static_cast<void**>(result);
+  return result;
+}
+//------------------------------------------------------------------------------
+
+void PooledRecord::operator delete(void* ptr, size_t size)
+{
+  if (!ptr) return;
+  size_t sizeClass = (size + POOL_GRAIN - 1) / POOL_GRAIN;
+  if (sizeClass >= POOL_CLASSES) { ::operator delete(ptr); return; }
+  *static_cast<void**>(ptr) = freeRecords[sizeClass];
+  freeRecords[sizeClass] = ptr;
+}
+//------------------------------------------------------------------------------
+
+void ReleasePooledRecords()
+{
+  for (size_t i = 0; i < POOL_CLASSES; ++i)
+    while (freeRecords[i])
+    {
+      void* next = *static_cast<void**>(freeRecords[i]);
+      ::operator delete(freeRecords[i]);
+      freeRecords[i] = next;
+    }
+}
+//------------------------------------------------------------------------------
+
 #define HORIZONTAL (-1.0E+40)
 #define NEAR_ZERO(val) (((val) > -TOLERANCE) && ((val) < TOLERANCE))
 #define NEAR_EQUAL(a, b) NEAR_ZERO((a) - (b))
@@ -3072,10 +3113,14 @@ private:
   Polygons m_p;
   Polygon* m_curr_poly;
   std::vector<DoublePoint> normals;
-  double m_delta, m_RMin, m_R;
+  double m_delta, m_RMin, m_R, m_MiterLimit;
   size_t m_i, m_j, m_k;
   static const int buffLength = 128;
   JoinType m_jointype;
+  //per polygon data that does not depend on delta ...
+  std::vector< std::vector<DoublePoint> > m_normals;
+  std::vector<double> m_areas;
+  std::vector<size_t> m_lengths;
  
 public:
 
@@ -3088,27 +3133,40 @@ PolyOffsetBuilder(const Polygons& in_polys, Polygons& out_polys,
         out_polys = in_polys;
         return;
     }
+    Prepare(in_polys, jointype, MiterLimit);
+    Execute(delta, out_polys);
+}
+//------------------------------------------------------------------------------
 
-    this->m_p = in_polys;
+//prepare for several calls to Execute with different deltas
+PolyOffsetBuilder(const Polygons& in_polys, JoinType jointype, 
+  double MiterLimit)
+{
+    Prepare(in_polys, jointype, MiterLimit);
+}
+//------------------------------------------------------------------------------
+
+void Execute(double delta, Polygons& out_polys)
+{
+    //nb precondition - out_polys != ptsin_polys
+    if (NEAR_ZERO(delta))
+    {
+        out_polys = m_p;
+        return;
+    }
     this->m_delta = delta;
-    this->m_jointype = jointype;
-    if (MiterLimit <= 1) MiterLimit = 1;
-    m_RMin = 2/(MiterLimit*MiterLimit);
  
     double deltaSq = delta*delta;
     out_polys.clear();
-    out_polys.resize(in_polys.size());
-    for (m_i = 0; m_i < in_polys.size(); m_i++)
+    out_polys.resize(m_p.size());
+    for (m_i = 0; m_i < m_p.size(); m_i++)
     {
         m_curr_poly = &out_polys[m_i];
-        size_t len = in_polys[m_i].size();
-		//if the first point is equal to the last point, discard the last point
-        if (len > 1 && m_p[m_i][0].X == m_p[m_i][len - 1].X &&
-            m_p[m_i][0].Y == m_p[m_i][len-1].Y) len--;
+        size_t len = m_lengths[m_i];
 
         //when 'shrinking' polygons - to minimize artefacts
         //strip those polygons that have an area < pi * delta^2 ...
-        double a1 = Area(in_polys[m_i]);
+        double a1 = m_areas[m_i];
         if (delta < 0) { if (a1 > 0 && a1 < deltaSq *pi) len = 0; }
         else if (a1 < 0 && -a1 < deltaSq *pi) len = 0; //holes have neg. area
 
@@ -3116,27 +3174,23 @@ PolyOffsetBuilder(const Polygons& in_polys, Polygons& out_polys,
           continue;
         else if (len == 1) {
             Polygon arc;
-            arc = BuildArc(in_polys[m_i][len-1], 0, 2 * pi, delta);
+            arc = BuildArc(m_p[m_i][len-1], 0, 2 * pi, delta);
             out_polys[m_i] = arc;
             continue;
         }
 
-        //build normals ...
-        normals.clear();
-        normals.resize(len);
-        normals[len-1] = GetUnitNormal(in_polys[m_i][len-1], in_polys[m_i][0]);
-        for (m_j = 0; m_j < len -1; ++m_j)
-            normals[m_j] = GetUnitNormal(in_polys[m_i][m_j], in_polys[m_i][m_j+1]);
+        //borrow the normals built in Prepare ...
+        normals.swap(m_normals[m_i]);
         
         m_k = len -1;
         for (m_j = 0; m_j < len; ++m_j) {
-          switch (jointype) {
+          switch (m_jointype) {
             case jtMiter:
             {
 			  //m_R = 1 + normals[m_j].dot(normals[m_k];
               m_R = 1 + (normals[m_j].X*normals[m_k].X + 
                 normals[m_j].Y*normals[m_k].Y);
-              if (m_R >= m_RMin) DoMiter(); else DoSquare(MiterLimit);
+              if (m_R >= m_RMin) DoMiter(); else DoSquare(m_MiterLimit);
               break;
             }
             case jtSquare: DoSquare(); break;
@@ -3144,6 +3198,7 @@ PolyOffsetBuilder(const Polygons& in_polys, Polygons& out_polys,
           }
         m_k = m_j;
         }
+        normals.swap(m_normals[m_i]);
     }
 
     //finally, clean up untidy corners using Clipper ...
@@ -3174,6 +3229,38 @@ PolyOffsetBuilder(const Polygons& in_polys, Polygons& out_polys,
 
 private:
 
+void Prepare(const Polygons& in_polys, JoinType jointype, double MiterLimit)
+{
+    this->m_p = in_polys;
+    this->m_jointype = jointype;
+    if (MiterLimit <= 1) MiterLimit = 1;
+    m_MiterLimit = MiterLimit;
+    m_RMin = 2/(MiterLimit*MiterLimit);
+
+    m_normals.resize(in_polys.size());
+    m_areas.resize(in_polys.size());
+    m_lengths.resize(in_polys.size());
+    for (size_t i = 0; i < in_polys.size(); i++)
+    {
+        size_t len = in_polys[i].size();
+		//if the first point is equal to the last point, discard the last point
+        if (len > 1 && m_p[i][0].X == m_p[i][len - 1].X &&
+            m_p[i][0].Y == m_p[i][len-1].Y) len--;
+        m_lengths[i] = len;
+        m_areas[i] = Area(in_polys[i]);
+        if (len < 2)
+          continue;
+
+        //build normals ...
+        std::vector<DoublePoint>& polyNormals = m_normals[i];
+        polyNormals.resize(len);
+        polyNormals[len-1] = GetUnitNormal(in_polys[i][len-1], in_polys[i][0]);
+        for (size_t j = 0; j < len -1; ++j)
+            polyNormals[j] = GetUnitNormal(in_polys[i][j], in_polys[i][j+1]);
+    }
+}
+//------------------------------------------------------------------------------
+
 void AddPoint(const IntPoint& pt)
 {
     Polygon::size_type len = m_curr_poly->size();
@@ -3277,6 +3364,18 @@ void OffsetPolygons(const Polygons &in_polys, Polygons &out_polys,
 }
 //------------------------------------------------------------------------------
 
+void OffsetPolygons(const Polygons &in_polys, 
+  std::vector<Polygons> &out_polys, const std::vector<double> &deltas, 
+  JoinType jointype, double MiterLimit)
+{
+  //nb in_polys must not be one of out_polys, which are resized here
+  PolyOffsetBuilder builder(in_polys, jointype, MiterLimit);
+  out_polys.resize(deltas.size());
+  for (std::vector<double>::size_type i = 0; i < deltas.size(); ++i)
+    builder.Execute(deltas[i], out_polys[i]);
+}
+//------------------------------------------------------------------------------
+
 void SimplifyPolygon(const Polygon &in_poly, Polygons &out_polys)
 {
   Clipper c;
@@ -81,6 +81,10 @@ bool Orientation(const Polygon &poly);
 double Area(const Polygon &poly);
 void OffsetPolygons(const Polygons &in_polys, Polygons &out_polys,
   double delta, JoinType jointype = jtSquare, double MiterLimit = 2);
+//offset in_polys once for each of deltas, sharing the per polygon setup
+void OffsetPolygons(const Polygons &in_polys, 
+  std::vector<Polygons> &out_polys, const std::vector<double> &deltas, 
+  JoinType jointype = jtSquare, double MiterLimit = 2);
 void SimplifyPolygon(const Polygon &in_poly, Polygons &out_polys);
 void SimplifyPolygons(const Polygons &in_polys, Polygons &out_polys);
 void SimplifyPolygons(Polygons &polys);
@@ -92,6 +96,17 @@ void ReversePoints(Polygons& p);
 enum EdgeSide { esLeft, esRight };
 enum IntersectProtects { ipNone = 0, ipLeft = 1, ipRight = 2, ipBoth = 3 };
 
+//The small records below are allocated and freed many times per Execute.
+//They come from per thread free lists so that a run of many clipping
+//operations keeps reusing the same memory instead of the heap.
+struct PooledRecord {
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+};
+
+//returns the calling thread's pooled records to the heap
+void ReleasePooledRecords();
+
 struct TEdge {
   long64 xbot;
   long64 ybot;
@@ -116,28 +131,28 @@ struct TEdge {
   TEdge *prevInSEL;
 };
 
-struct IntersectNode {
+struct IntersectNode : PooledRecord {
   TEdge          *edge1;
   TEdge          *edge2;
   IntPoint        pt;
   IntersectNode  *next;
 };
 
-struct LocalMinima {
+struct LocalMinima : PooledRecord {
   long64        Y;
   TEdge        *leftBound;
   TEdge        *rightBound;
   LocalMinima  *next;
 };
 
-struct Scanbeam {
+struct Scanbeam : PooledRecord {
   long64    Y;
   Scanbeam *next;
 };
 
 struct OutPt; //forward declaration
 
-struct OutRec {
+struct OutRec : PooledRecord {
   int     idx;
   bool    isHole;
   OutRec *FirstLeft;
@@ -148,14 +163,14 @@ struct OutRec {
   TEdge  *bottomE2;
 };
 
-struct OutPt {
+struct OutPt : PooledRecord {
   int     idx;
   IntPoint pt;
   OutPt   *next;
   OutPt   *prev;
 };
 
-struct JoinRec {
+struct JoinRec : PooledRecord {
   IntPoint  pt1a;
   IntPoint  pt1b;
   int       poly1Idx;
@@ -164,7 +179,7 @@ struct JoinRec {
   int       poly2Idx;
 };
 
-struct HorzJoinRec {
+struct HorzJoinRec : PooledRecord {
   TEdge    *edge;
   int       savedIdx;
 };
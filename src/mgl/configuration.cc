@@ -193,6 +193,7 @@ GrueConfig::GrueConfig()
         minLayerDuration(INVALID_SCALAR), 
         minSpeedMultiplier(INVALID_SCALAR),
         coarseness(INVALID_SCALAR), preCoarseness(INVALID_SCALAR), 
+        coarsenessMode(COARSENESS_SMOOTH), 
         directionWeight(INVALID_SCALAR), 
         layerH(INVALID_SCALAR), firstLayerZ(INVALID_SCALAR), 
         infillDensity(INVALID_SCALAR), nbOfShells(INVALID_UINT), 
@@ -202,6 +203,8 @@ GrueConfig::GrueConfig()
         infillShellSpacingMultiplier(INVALID_SCALAR), 
         roofLayerCount(INVALID_UINT), 
         floorLayerCount(INVALID_UINT), 
+        regionBackend(REGION_POLYGON), rasterOversample(INVALID_UINT), 
+        doLayerReuse(INVALID_BOOL), 
         //spur stuff begin
         doExternalSpurs(INVALID_BOOL),
         doInternalSpurs(INVALID_BOOL),
@@ -215,7 +218,8 @@ GrueConfig::GrueConfig()
         raftInterfaceThickness(INVALID_SCALAR), raftOutset(INVALID_SCALAR), 
         raftModelSpacing(INVALID_SCALAR), raftDensity(INVALID_SCALAR), 
         doSupport(INVALID_BOOL), supportMargin(INVALID_SCALAR), 
-        supportDensity(INVALID_SCALAR), doGraphOptimization(INVALID_BOOL), 
+        supportDensity(INVALID_SCALAR), supportVertexBudget(INVALID_UINT), 
+        doGraphOptimization(INVALID_BOOL), 
         doFixedLayerStart(INVALID_BOOL), 
         rapidMoveFeedRateXY(INVALID_SCALAR), rapidMoveFeedRateZ(INVALID_SCALAR), 
         useEaxis(INVALID_BOOL), 
@@ -253,6 +257,15 @@ void GrueConfig::loadSlicingParams(const Configuration& config) {
             config["coarseness"], "coarseness"));
     preCoarseness = (doubleCheck(
             config["preCoarseness"], "preCoarseness"));
+    std::string mode = stringCheck(config["coarsenessMode"], 
+            "coarsenessMode", "smooth");
+    if(mode == "smooth")
+        coarsenessMode = COARSENESS_SMOOTH;
+    else if(mode == "simplify")
+        coarsenessMode = COARSENESS_SIMPLIFY;
+    else
+        throw ConfigException(
+                "coarsenessMode must be \"smooth\" or \"simplify\"");
     directionWeight = doubleCheck(config["directionWeight"],
             "directionWeight", 0.5);
     layerH = (doubleCheck(
@@ -295,6 +308,20 @@ void GrueConfig::loadSlicingParams(const Configuration& config) {
     infillShellSpacingMultiplier = 
             doubleCheck(config["infillShellSpacingMultiplier"], 
             "infillShellSpacingMultiplier");
+    std::string backend = stringCheck(config["regionBackend"], 
+            "regionBackend", "polygon");
+    if(backend == "polygon")
+        regionBackend = REGION_POLYGON;
+    else if(backend == "raster")
+        regionBackend = REGION_RASTER;
+    else
+        throw ConfigException(
+                "regionBackend must be \"polygon\" or \"raster\"");
+    rasterOversample = uintCheck(config["rasterOversample"], 
+            "rasterOversample", 2);
+    if(rasterOversample == 0)
+        throw ConfigException("rasterOversample must be at least 1");
+    doLayerReuse = boolCheck(config["doLayerReuse"], "doLayerReuse", true);
     loadSolidLayerParams(config);
 }
 void GrueConfig::loadGantryParams(const Configuration& config) {
@@ -381,6 +408,8 @@ void GrueConfig::loadSupportParams(const Configuration& config) {
                 "supportMargin");
     supportDensity = doubleCheck(
             config["supportDensity"], "supportDensity");
+    supportVertexBudget = uintCheck(config["supportVertexBudget"], 
+            "supportVertexBudget", 20000);
 }
 void GrueConfig::loadPathingParams(const Configuration& config) {}
 void GrueConfig::loadProfileParams(const Configuration& config) {
@@ -148,6 +148,16 @@ public:
     
     typedef std::map<std::string, Extrusion> profileNameMap;
     typedef std::vector<Extruder> extruderVector;
+    /// how coarseness and preCoarseness reduce the points of loops and paths
+    enum CoarsenessMode {
+        COARSENESS_SMOOTH,  //< cumulative deviation smoothing
+        COARSENESS_SIMPLIFY //< Douglas-Peucker within a fixed distance
+    };
+    /// how roofs, floors and support are worked out between layers
+    enum RegionBackend {
+        REGION_POLYGON, //< exact polygon booleans
+        REGION_RASTER   //< booleans on bitmaps of each layer
+    };
 private:
     static const Scalar INVALID_SCALAR;// = std::numeric_limits<Scalar>::min();
     static const unsigned int INVALID_UINT = -1;
@@ -190,6 +200,7 @@ private:
     GRUECONFIG_PUBLIC_CONST_ACCESSOR(Scalar, minSpeedMultiplier)
     GRUECONFIG_PUBLIC_CONST_ACCESSOR(Scalar, coarseness)
     GRUECONFIG_PUBLIC_CONST_ACCESSOR(Scalar, preCoarseness)
+    GRUECONFIG_PUBLIC_CONST_ACCESSOR(CoarsenessMode, coarsenessMode)
     GRUECONFIG_PUBLIC_CONST_ACCESSOR(Scalar, directionWeight)
     //slicer
     GRUECONFIG_PUBLIC_CONST_ACCESSOR(Scalar, layerH)
@@ -205,6 +216,9 @@ private:
     GRUECONFIG_PUBLIC_CONST_ACCESSOR(Scalar, infillShellSpacingMultiplier)
     GRUECONFIG_PUBLIC_CONST_ACCESSOR(unsigned, roofLayerCount)
     GRUECONFIG_PUBLIC_CONST_ACCESSOR(unsigned, floorLayerCount)
+    GRUECONFIG_PUBLIC_CONST_ACCESSOR(RegionBackend, regionBackend)
+    GRUECONFIG_PUBLIC_CONST_ACCESSOR(unsigned, rasterOversample)
+    GRUECONFIG_PUBLIC_CONST_ACCESSOR(bool, doLayerReuse)
     GRUECONFIG_PUBLIC_CONST_ACCESSOR(bool, doExternalSpurs)
     GRUECONFIG_PUBLIC_CONST_ACCESSOR(bool, doInternalSpurs)
     GRUECONFIG_PUBLIC_CONST_ACCESSOR(Scalar, minSpurWidth)
@@ -224,6 +238,7 @@ private:
     GRUECONFIG_PUBLIC_CONST_ACCESSOR(bool, doSupport)
     GRUECONFIG_PUBLIC_CONST_ACCESSOR(Scalar, supportMargin)
     GRUECONFIG_PUBLIC_CONST_ACCESSOR(Scalar, supportDensity)
+    GRUECONFIG_PUBLIC_CONST_ACCESSOR(unsigned, supportVertexBudget)
     //pather
     GRUECONFIG_PUBLIC_CONST_ACCESSOR(bool, doGraphOptimization)
     GRUECONFIG_PUBLIC_CONST_ACCESSOR(bool, doFixedLayerStart);
@@ -11,6 +11,7 @@
 
 #include <set>
 #include <map>
+#include <algorithm>
 
 #include "grid.h"
 #include "log.h"
@@ -25,7 +26,6 @@ using namespace std;
 
 
 const Scalar GRID_RANGE_TOL = 0.0;
-const Scalar GRID_CROSSING_COARSENESS = 0.0;
 
 ostream& operator <<(std::ostream &os, const ScalarRange &p) {
 	cout << "[" << p.min << ", " << p.max << "]";
@@ -87,50 +87,130 @@ void scalarRangesFromIntersections(std::vector<Scalar> &lineCuts, std::vector<Sc
 	}
 }
 
-void rayCastAlongX(const std::list<Loop>& outlineLoops,
-		Scalar y,
-		Scalar xMin,
-		Scalar xMax,
-		std::vector<ScalarRange> &ranges) {
-	std::vector<Scalar> lineCuts;
-
+/**
+ A loop segment as seen by parallel rays: the rays at values in 
+ [first, last) across them cut it. For rays along y the segment is kept 
+ with x and y exchanged, so both directions share the code for rays along x.
+ */
+struct RayEdge {
+	Segment2Type segment;
+	Scalar first;
+	Scalar last;
+	bool operator<(const RayEdge& other) const { return first < other.first; }
+};
+
+static void collectRayEdges(const std::list<Loop>& outlineLoops, 
+		bool exchangeAxes, 
+		std::vector<RayEdge>& edges) {
 	//iterate over every loop
 	for (std::list<Loop>::const_iterator j = outlineLoops.begin(); 
 			j != outlineLoops.end(); 
 			++j) {
 		const Loop& currentLoop = *j;
 		//iterate over each line segment in the loop
-		if(!currentLoop.empty()) {
-			for(Loop::const_finite_cw_iterator iter(currentLoop.clockwiseFinite()); 
-					iter != currentLoop.clockwiseEnd(); 
-					++iter) {
-				Segment2Type segment = currentLoop.segmentAfterPoint(iter);
-				Scalar intersectionX, intersectionY;
-                intersectionY = y;
-                if(segment.a.y < y + GRID_CROSSING_COARSENESS) {
-                    if(segment.b.y > y - GRID_CROSSING_COARSENESS) {
-                        Scalar t = (y - segment.a.y) / 
-                                (segment.b.y - segment.a.y);
-                        intersectionX = t * (segment.b.x - segment.a.x) + segment.a.x;
-                    } else {
-                        continue;
-                    }
-                } else if(segment.a.y > y - GRID_CROSSING_COARSENESS) {    // segment.a.y > y
-                    if(segment.b.y < y + GRID_CROSSING_COARSENESS) {
-                        Scalar t = (y - segment.b.y) / 
-                                (segment.a.y - segment.b.y);
-                        intersectionX = t * (segment.a.x - segment.b.x) + segment.b.x;
-                    } else {
-                        continue;
-                    }
-                }
-				if (intersectionX >= xMin && intersectionX < xMax) {
-					lineCuts.push_back(intersectionX);
-				}
+		if(currentLoop.empty())
+			continue;
+		for(Loop::const_finite_cw_iterator iter(currentLoop.clockwiseFinite()); 
+				iter != currentLoop.clockwiseEnd(); 
+				++iter) {
+			RayEdge edge;
+			edge.segment = currentLoop.segmentAfterPoint(iter);
+			if(exchangeAxes) {
+				std::swap(edge.segment.a.x, edge.segment.a.y);
+				std::swap(edge.segment.b.x, edge.segment.b.y);
+			}
+			//segments parallel to the rays are never cut
+			if(edge.segment.a.y == edge.segment.b.y)
+				continue;
+			edge.first = std::min(edge.segment.a.y, edge.segment.b.y);
+			edge.last = std::max(edge.segment.a.y, edge.segment.b.y);
+			edges.push_back(edge);
+		}
+	}
+}
+
+/**
+ @brief x where the ray along x at @a y cuts @a segment, which must span it
+ 
+ A point exactly on the ray belongs to the segment above it, so a ray 
+ through a vertex cuts the outline once where it crosses and not at all 
+ where it only touches.
+ */
+static Scalar crossingAlongX(const Segment2Type& segment, Scalar y) {
+	if(segment.a.y < segment.b.y) {
+		Scalar t = (y - segment.a.y) / 
+				(segment.b.y - segment.a.y);
+		return t * (segment.b.x - segment.a.x) + segment.a.x;
+	}
+	Scalar t = (y - segment.b.y) / 
+			(segment.a.y - segment.b.y);
+	return t * (segment.a.x - segment.b.x) + segment.b.x;
+}
+
+/**
+ @brief cast rays along x at each of @a yValues, which must be increasing, 
+ through @a edges
+ 
+ The rays are swept upward over the edges sorted by where they start, 
+ keeping only the edges that span the current ray. Rays below or above 
+ all of the edges are left empty without looking at any of them.
+ */
+static void castRaysOnEdges(std::vector<RayEdge>& edges, 
+		const std::vector<Scalar>& yValues, 
+		Scalar xMin, 
+		Scalar xMax, 
+		ScalarRangeTable& rangeTable) {
+	assert(rangeTable.empty());
+	if(edges.empty()) {
+		rangeTable.resize(yValues.size());
+		return;
+	}
+	std::sort(edges.begin(), edges.end());
+
+	std::vector<const RayEdge*> active;
+	std::vector<Scalar> lineCuts;
+	std::vector<ScalarRange> lineRanges;
+	size_t nextEdge = 0;
+	rangeTable.resize(std::lower_bound(yValues.begin(), yValues.end(), 
+			edges.front().first) - yValues.begin());
+	for(size_t i = rangeTable.size(); i < yValues.size(); ++i) {
+		Scalar y = yValues[i];
+		while(nextEdge < edges.size() && edges[nextEdge].first <= y)
+			active.push_back(&edges[nextEdge++]);
+		//drop the edges this ray has passed
+		size_t kept = 0;
+		for(size_t edge = 0; edge < active.size(); ++edge) {
+			if(active[edge]->last > y)
+				active[kept++] = active[edge];
+		}
+		active.resize(kept);
+		if(active.empty() && nextEdge == edges.size())
+			break;
+
+		lineCuts.clear();
+		for(size_t edge = 0; edge < active.size(); ++edge) {
+			Scalar intersectionX = crossingAlongX(active[edge]->segment, y);
+			if (intersectionX >= xMin && intersectionX < xMax) {
+				lineCuts.push_back(intersectionX);
 			}
 		}
+		lineRanges.clear();
+		scalarRangesFromIntersections(lineCuts, lineRanges);
+		rangeTable.addRow();
+		rangeTable.append(lineRanges);
 	}
-	scalarRangesFromIntersections(lineCuts, ranges);
+	rangeTable.resize(yValues.size());
+}
+
+void rayCastAlongX(const std::list<Loop>& outlineLoops,
+		Scalar y,
+		Scalar xMin,
+		Scalar xMax,
+		std::vector<ScalarRange> &ranges) {
+	ScalarRangeTable rangeTable;
+	castRaysOnSliceAlongX(outlineLoops, std::vector<Scalar>(1, y), 
+			xMin, xMax, rangeTable);
+	ranges.assign(rangeTable[0].begin(), rangeTable[0].end());
 }
 
 void rayCastAlongY(const std::list<Loop>& outlineLoops,
@@ -138,44 +218,10 @@ void rayCastAlongY(const std::list<Loop>& outlineLoops,
 		Scalar yMin,
 		Scalar yMax,
 		std::vector<ScalarRange> &ranges) {
-	std::vector<Scalar> lineCuts;
-
-	// iterate over every loop
-	for (std::list<Loop>::const_iterator j = outlineLoops.begin(); 
-			j != outlineLoops.end(); 
-			++j) {
-		const Loop& currentLoop = *j;
-		if(!currentLoop.empty()){
-			for (Loop::const_finite_cw_iterator it(currentLoop.clockwiseFinite()); 
-					it != currentLoop.clockwiseEnd(); 
-					it++) {
-				Segment2Type segment = currentLoop.segmentAfterPoint(it);
-				Scalar intersectionX, intersectionY;
-                intersectionX = x;
-                if(segment.a.x < x + GRID_CROSSING_COARSENESS) {
-                    if(segment.b.x > x - GRID_CROSSING_COARSENESS) {
-                        Scalar t = (x - segment.a.x) / 
-                                (segment.b.x - segment.a.x);
-                        intersectionY = t * (segment.b.y - segment.a.y) + segment.a.y;
-                    } else {
-                        continue;
-                    }
-                } else if(segment.a.x > x - GRID_CROSSING_COARSENESS) {    // segment.a.y > y
-                    if(segment.b.x < x + GRID_CROSSING_COARSENESS) {
-                        Scalar t = (x - segment.b.x) / 
-                                (segment.a.x - segment.b.x);
-                        intersectionY = t * (segment.a.y - segment.b.y) + segment.b.y;
-                    } else {
-                        continue;
-                    }
-                }
-				if (intersectionY >= yMin && intersectionY < yMax) {
-					lineCuts.push_back(intersectionY);
-				}
-			}
-		}
-	}
-	scalarRangesFromIntersections(lineCuts, ranges);
+	ScalarRangeTable rangeTable;
+	castRaysOnSliceAlongY(outlineLoops, std::vector<Scalar>(1, x), 
+			yMin, yMax, rangeTable);
+	ranges.assign(rangeTable[0].begin(), rangeTable[0].end());
 }
 
 void castRaysOnSliceAlongX(const std::list<Loop> &outlineLoops,
@@ -183,14 +229,9 @@ void castRaysOnSliceAlongX(const std::list<Loop> &outlineLoops,
 		Scalar xMin,
 		Scalar xMax,
 		ScalarRangeTable &rangeTable) {
-	assert(rangeTable.size() == 0);
-	rangeTable.resize(yValues.size());
-
-	for (size_t i = 0; i < rangeTable.size(); i++) {
-		Scalar y = yValues[i];
-		std::vector<ScalarRange> &ranges = rangeTable[i];
-		rayCastAlongX(outlineLoops, y, xMin, xMax, ranges);
-	}
+	std::vector<RayEdge> edges;
+	collectRayEdges(outlineLoops, false, edges);
+	castRaysOnEdges(edges, yValues, xMin, xMax, rangeTable);
 }
 
 void castRaysOnSliceAlongY(const std::list<Loop> &outlineLoops,
@@ -198,14 +239,9 @@ void castRaysOnSliceAlongY(const std::list<Loop> &outlineLoops,
 		Scalar min,
 		Scalar max,
 		ScalarRangeTable &rangeTable) {
-	assert(rangeTable.size() == 0);
-	rangeTable.resize(values.size());
-
-	for (size_t i = 0; i < rangeTable.size(); i++) {
-		Scalar value = values[i];
-		std::vector<ScalarRange> &ranges = rangeTable[i];
-		rayCastAlongY(outlineLoops, value, min, max, ranges);
-	}
+	std::vector<RayEdge> edges;
+	collectRayEdges(outlineLoops, true, edges);
+	castRaysOnEdges(edges, values, min, max, rangeTable);
 }
 
 
@@ -228,29 +264,26 @@ bool crossesOutlines(const Segment2Type &seg,
 	return false;
 }
 
-void Grid::gridRangesToOpenPaths(const ScalarRangeTable &rays,
+void Grid::gridRangesToOpenPaths(const ScalarRangeTableView &rays,
 								 const std::vector<Scalar> &values,
 								 const axis_e axis,
 								 OpenPathList &paths) const {
 
-	std::vector<Scalar>::const_iterator value = values.begin();
-	ScalarRangeTable::const_iterator ray = rays.begin();
-
-	for (;
-		 ray != rays.end() && value != values.end(); 
-		 ++value, ++ray) {
-		for (vector<ScalarRange>::const_iterator range = ray->begin();
-			 range != ray->end(); ++range) {
+	for (size_t i = 0; i < rays.size() && i < values.size(); ++i) {
+		const ScalarRangeTable::Row ray = rays[i];
+		Scalar value = values[i];
+		for (ScalarRangeTable::Row::const_iterator range = ray.begin();
+			 range != ray.end(); ++range) {
 			paths.push_back(OpenPath());
 
 			OpenPath &path = paths.back();
 
 			if (axis == X_AXIS) {
-				path.appendPoint(Point2Type(range->min, *value));
-				path.appendPoint(Point2Type(range->max, *value));
+				path.appendPoint(Point2Type(range->min, value));
+				path.appendPoint(Point2Type(range->max, value));
 			} else {
-				path.appendPoint(Point2Type(*value, range->min));
-				path.appendPoint(Point2Type(*value, range->max));
+				path.appendPoint(Point2Type(value, range->min));
+				path.appendPoint(Point2Type(value, range->max));
 			}
 		}
 	}
@@ -261,7 +294,7 @@ typedef map<int, int> PointMap;
 typedef PointMap::iterator PointIter;
 
 
-void pathsFromScalarRangesAlongAxis( const ScalarRangeTable &rays,	   // the ranges along this axis, multiple per lines
+void pathsFromScalarRangesAlongAxis( const ScalarRangeTableView &rays,	   // the ranges along this axis, multiple per lines
 									 const std::vector<Scalar> &values, // the opposite axis values for each line
 									 const axis_e axis,
 									 const LoopList &outlines,
@@ -274,13 +307,13 @@ void pathsFromScalarRangesAlongAxis( const ScalarRangeTable &rays,	   // the ran
 	//Convert ray ranges to segments and map endpoints
 	vector<Point2Type> points;
 	for (size_t i = 0; i < rays.size(); i++) {
-		const vector<ScalarRange> &ray = rays[i];
+		const ScalarRangeTable::Row ray = rays[i];
 
 		if (ray.size() == 0) continue;
 
 		Scalar val = values[i];
 
-		for (vector<ScalarRange>::const_iterator j = ray.begin();
+		for (ScalarRangeTable::Row::const_iterator j = ray.begin();
 				j != ray.end(); j++) {
 
 			assert(j->min != j->max);
@@ -384,19 +417,19 @@ vector< ScalarRange >::const_iterator subRangeTersect(
 			return it;
 		}
 
-		ScalarRange intersection;
+		Scalar intersectionMin, intersectionMax;
 		// cout << " second="<< currentRange << endl;
-		if (intersectRange(range.min, range.max, currentRange.min, currentRange.max, intersection.min, intersection.max)) {
+		if (intersectRange(range.min, range.max, currentRange.min, currentRange.max, intersectionMin, intersectionMax)) {
 			// cout << " Intersect: [" << range.min << ", " << range.max << "]"<< endl;
-			result.push_back(intersection);
+			result.push_back(ScalarRange(intersectionMin, intersectionMax));
 		}
 		it++;
 	}
 	return it;
 }
 
-void rangeTersection(const vector< ScalarRange > &oneLine,
-		const vector< ScalarRange > &twoLine,
+void rangeTersection(const ScalarRangeTable::Row &oneLine,
+		const ScalarRangeTable::Row &twoLine,
 		vector< ScalarRange > &boolLine) {
 	//	static int toto = 0;
 	//	toto ++;
@@ -484,15 +517,15 @@ vector< ScalarRange >::const_iterator subRangeUnion(const ScalarRange &initialRa
 	return it;
 }
 
-void rangeUnion(const vector< ScalarRange > &firstLine,
-		const vector< ScalarRange > &secondLine,
+void rangeUnion(const ScalarRangeTable::Row &firstLine,
+		const ScalarRangeTable::Row &secondLine,
 		vector< ScalarRange > &unionLine) {
 	vector< ScalarRange >::const_iterator itOne = firstLine.begin();
 	vector< ScalarRange >::const_iterator itTwo = secondLine.begin();
 
 	// the first line is empty... return the second one
 	if (itOne == firstLine.end()) {
-		unionLine = secondLine;
+		unionLine.assign(secondLine.begin(), secondLine.end());
 		return;
 	}
 
@@ -623,8 +656,8 @@ vector< ScalarRange >::const_iterator subRangeDifference(
 	return it;
 }
 
-void rangeDifference(const vector< ScalarRange > &srcLine,
-		const vector< ScalarRange > &delLine,
+void rangeDifference(const ScalarRangeTable::Row &srcLine,
+		const ScalarRangeTable::Row &delLine,
 		vector< ScalarRange > &diffLine) {
 	vector< ScalarRange >::const_iterator itOne = srcLine.begin();
 	vector< ScalarRange >::const_iterator itTwo = delLine.begin();
@@ -645,10 +678,22 @@ void rangeDifference(const vector< ScalarRange > &srcLine,
 	}
 }
 
+// copies the rows of a table or of a view of one
+
+static void copyRangeTable(const ScalarRangeTableView &src, 
+		ScalarRangeTable &result) {
+	result.clear();
+	result.reserve(src.size(), src.rangeCount());
+	for (size_t i = 0; i < src.size(); i++) {
+		result.addRow();
+		result.append(src[i]);
+	}
+}
+
 // computes the difference between the ranges of two layers
 
-void rangeTableDifference(const ScalarRangeTable &src,
-		const ScalarRangeTable &del,
+void rangeTableDifference(const ScalarRangeTableView &src,
+		const ScalarRangeTableView &del,
 		ScalarRangeTable &diff) {
 
 	size_t lineCount = src.size();
@@ -656,23 +701,26 @@ void rangeTableDifference(const ScalarRangeTable &src,
 		size_t delSize = del.size();
 		assert(lineCount == delSize);
 	}
-	diff.resize(lineCount);
+	diff.clear();
+	diff.reserve(lineCount, src.rangeCount() + del.rangeCount());
 
-	for (size_t i = 0; i < src.size(); i++) {
-		const vector<ScalarRange> &lineRangeSrc = src[i];
-		const vector<ScalarRange> &lineRangeDel = del[i];
-		vector<ScalarRange> &lineRangeDiff = diff[i];
-
-		rangeDifference(lineRangeSrc, lineRangeDel, lineRangeDiff);
+	// each line is worked out in the same buffer, then appended to diff
+	vector<ScalarRange> lineRangeDiff;
+	for (size_t i = 0; i < lineCount; i++) {
+		lineRangeDiff.clear();
+		rangeDifference(src[i], del[i], lineRangeDiff);
+		diff.addRow();
+		diff.append(lineRangeDiff);
 	}
 
 
 }
 
-void rangeTableIntersection(const ScalarRangeTable &a,
-		const ScalarRangeTable &b,
+void rangeTableIntersection(const ScalarRangeTableView &a,
+		const ScalarRangeTableView &b,
 		ScalarRangeTable &result) {
 	size_t lineCount = a.size();
+	result.clear();
 
 	if (a.size() == 0) {
 		result.resize(b.size());
@@ -684,43 +732,43 @@ void rangeTableIntersection(const ScalarRangeTable &a,
 	}
 	
 	assert(lineCount == b.size());
-	result.resize(lineCount);
+	result.reserve(lineCount, std::min(a.rangeCount(), b.rangeCount()));
 
+	vector<ScalarRange> lineRangeRes;
 	for (size_t i = 0; i < lineCount; i++) {
-		const vector<ScalarRange> &lineRange0 = a[i];
-		const vector<ScalarRange> &lineRange1 = b[i];
-		vector<ScalarRange> &lineRangeRes = result[i];
+		lineRangeRes.clear();
 		// cout << "rangeTableIntersection " << i << endl;
-		rangeTersection(lineRange0, lineRange1, lineRangeRes);
+		rangeTersection(a[i], b[i], lineRangeRes);
+		result.addRow();
+		result.append(lineRangeRes);
 	}
 }
 
-void rangeTableUnion(const ScalarRangeTable &a,
-		const ScalarRangeTable &b,
+void rangeTableUnion(const ScalarRangeTableView &a,
+		const ScalarRangeTableView &b,
 		ScalarRangeTable &result) {
 	size_t lineCount = a.size();
 	// cout << " rangeTableUnion " << lineCount << " vs " << b.size() << endl;
 
 	if (a.size() == 0) {
-		result = b;
+		copyRangeTable(b, result);
 		return;
 	}
 	else if (b.size() == 0) {
-		result = a;
+		copyRangeTable(a, result);
 		return;
 	}
 
 	assert(lineCount == b.size());
-	result.resize(lineCount);
+	result.clear();
+	result.reserve(lineCount, a.rangeCount() + b.rangeCount());
 
+	vector<ScalarRange> lineRangeRes;
 	for (size_t i = 0; i < a.size(); i++) {
-		const vector<ScalarRange> &lineRange0 = a[i];
-		const vector<ScalarRange> &lineRange1 = b[i];
-		vector<ScalarRange> &lineRangeRes = result[i];
-		if (lineRangeRes.size() > 0) {
-			assert(0);
-		}
-		rangeUnion(lineRange0, lineRange1, lineRangeRes);
+		lineRangeRes.clear();
+		rangeUnion(a[i], b[i], lineRangeRes);
+		result.addRow();
+		result.append(lineRangeRes);
 	}
 }
 
@@ -786,21 +834,18 @@ void Grid::subSample(const GridRanges &gridRanges,
 	assert(result.xRays.size() == 0);
 	assert(result.yRays.size() == 0);
 
-	result.xRays.resize(gridRanges.xRays.size());
-	result.yRays.resize(gridRanges.yRays.size());
-
-	for (size_t i = 0; i < gridRanges.xRays.size(); i++) {
-		result.xRays[i] = gridRanges.xRays[i]; // deep copy of the ranges for the selected lines
-		i += skipCount; // skip lines depending on selected infill density
-	}
+	GridRangesView selected = subSample(gridRanges, skipCount);
+	copyRangeTable(selected.xRays, result.xRays);
+	copyRangeTable(selected.yRays, result.yRays);
+}
 
-	for (size_t i = 0; i < gridRanges.yRays.size(); i++) {
-		result.yRays[i] = gridRanges.yRays[i]; // deep copy of the ranges for the selected lines
-		i += skipCount; // skip lines depending on selected infill density
-	}
+GridRangesView Grid::subSample(const GridRanges &gridRanges, 
+		size_t skipCount) const {
+	// skip lines depending on selected infill density
+	return GridRangesView(gridRanges, skipCount + 1);
 }
 
-void Grid::pathsFromRanges(const GridRanges &gridRanges,
+void Grid::pathsFromRanges(const GridRangesView &gridRanges,
 						   const LoopList &outlines,
 						   const bool xDirection, OpenPathList &paths) const
 {
@@ -817,33 +862,31 @@ void Grid::pathsFromRanges(const GridRanges &gridRanges,
 	}
 }
 
-void Grid::gridRangeUnion(const GridRanges& a, 
-		const GridRanges &b, 
+void Grid::gridRangeUnion(const GridRangesView& a, 
+		const GridRangesView &b, 
 		GridRanges &result) const {
 	rangeTableUnion(a.xRays, b.xRays, result.xRays);
 	rangeTableUnion(a.yRays, b.yRays, result.yRays);
 }
 
-void Grid::gridRangeDifference(const GridRanges& src, 
-		const GridRanges &del, 
+void Grid::gridRangeDifference(const GridRangesView& src, 
+		const GridRangesView &del, 
 		GridRanges &result) const {
 	rangeTableDifference(src.xRays, del.xRays, result.xRays);
 	rangeTableDifference(src.yRays, del.yRays, result.yRays);
 
 }
 
-void Grid::gridRangeIntersection(const GridRanges& a, 
-		const GridRanges &b, 
+void Grid::gridRangeIntersection(const GridRangesView& a, 
+		const GridRangesView &b, 
 		GridRanges &result) const {
 	rangeTableIntersection(a.xRays, b.xRays, result.xRays);
 	rangeTableIntersection(a.yRays, b.yRays, result.yRays);
 }
 
-void rangeTrim(const vector<ScalarRange> &src, 
-		Scalar cutOff, vector<ScalarRange> &result) {
-	assert(result.size() == 0);
+void rangeTrim(const ScalarRangeTable::Row &src, 
+		Scalar cutOff, ScalarRangeTable &result) {
 	// cout << "rangeTrim" << endl;
-	result.reserve(src.size());
 	for (size_t i = 0; i < src.size(); i++) {
 		const ScalarRange range = src[i];
 		if (!tequals(range.max, range.min, cutOff)) {
@@ -854,30 +897,28 @@ void rangeTrim(const vector<ScalarRange> &src,
 	// cout << endl;
 }
 
-void rangeTableTrim(const ScalarRangeTable &src, 
+void rangeTableTrim(const ScalarRangeTableView &src, 
 		Scalar cutOff, 
 		ScalarRangeTable &result) {
 	//cout << "rangeTableTrim" << endl;
 	assert(result.size() == 0);
-	result.resize(src.size());
+	result.reserve(src.size(), src.rangeCount());
 	for (size_t i = 0; i < src.size(); i++) {
-		const vector<ScalarRange> &lineSrc = src[i];
-		vector<ScalarRange> &lineTrims = result[i];
-		rangeTrim(lineSrc, cutOff, lineTrims);
+		result.addRow();
+		rangeTrim(src[i], cutOff, result);
 	}
 }
 
-void dumpRangeTable(const ScalarRangeTable &table) {
+void dumpRangeTable(const ScalarRangeTableView &table) {
 	cout << "Rays " << table.size() << ":";
-	for (ScalarRangeTable::const_iterator ranges = table.begin();
-		 ranges != table.end(); ranges++) {
-		cout << ranges->size() << ", ";
+	for (size_t i = 0; i < table.size(); i++) {
+		cout << table[i].size() << ", ";
 	}
 
 	cout << endl;
 }
 
-void Grid::trimGridRange(const GridRanges& src, 
+void Grid::trimGridRange(const GridRangesView& src, 
 		Scalar cutOff, 
 		GridRanges &result) const {
 	rangeTableTrim(src.xRays, cutOff, result.xRays);
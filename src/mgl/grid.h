@@ -22,24 +22,27 @@
 namespace mgl
 {
 
-class ScalarRange {
+/**
+ @brief A span [min, max] along one grid line
+ @param T type used to store the endpoints
+ 
+ Endpoints are accepted as Scalar so callers may do their math at full 
+ precision regardless of how ranges are stored.
+ */
+template <typename T>
+class basic_scalar_range {
 public:
-	Scalar min;
-	Scalar max;
-	ScalarRange(Scalar a = 0, Scalar b = 0)	: min(a), max(b) {}
-	ScalarRange(const ScalarRange& original) {
-		this->min = original.min;
-		this->max = original.max;
-	}
-	ScalarRange& operator = (const ScalarRange& next) {
-		if( &next != this) {
-			this->min = next.min;
-			this->max = next.max;
-		}
-		return *this;
-	}
+	typedef T value_type;
+	T min;
+	T max;
+	basic_scalar_range(Scalar a = 0, Scalar b = 0) : min(a), max(b) {}
+	template <typename U>
+	basic_scalar_range(const basic_scalar_range<U>& original) 
+			: min(original.min), max(original.max) {}
 };
 
+typedef basic_scalar_range<StorageScalar> ScalarRange;
+
 class GridException : public mgl::Exception {
 public: 
 	GridException(const char *msg) :Exception(msg){} 
@@ -47,30 +50,161 @@ public:
 
 std::ostream& operator << (std::ostream &os, const ScalarRange &pt);
 
-typedef std::vector<std::vector<ScalarRange> > ScalarRangeTable;
+/**
+ @brief The ranges along each of a set of parallel grid lines
+ 
+ Rows, one per grid line, are stored one after the other in a single 
+ array of ranges, with a second array of where each row starts. A table is 
+ built a row at a time: addRow starts an empty row after the last one and 
+ push_back or append add ranges to the end of that last row. Reading a row 
+ gives a Row, a view into the table that stays valid until the table 
+ changes.
+ */
+class ScalarRangeTable {
+public:
+	/// the ranges of one row, or of a vector of ranges, without a copy
+	class Row {
+	public:
+		typedef std::vector<ScalarRange>::const_iterator const_iterator;
+		Row() {}
+		Row(const_iterator rowBegin, const_iterator rowEnd) 
+				: first(rowBegin), last(rowEnd) {}
+		Row(const std::vector<ScalarRange>& line) 
+				: first(line.begin()), last(line.end()) {}
+		const_iterator begin() const { return first; }
+		const_iterator end() const { return last; }
+		size_t size() const { return last - first; }
+		bool empty() const { return first == last; }
+		const ScalarRange& operator[](size_t index) const { 
+			return first[index]; 
+		}
+		const ScalarRange& front() const { return *first; }
+		const ScalarRange& back() const { return *(last - 1); }
+	private:
+		const_iterator first;
+		const_iterator last;
+	};
+
+	ScalarRangeTable() : offsets(1, 0) {}
+	/// number of rows
+	size_t size() const { return offsets.size() - 1; }
+	bool empty() const { return size() == 0; }
+	Row operator[](size_t row) const {
+		return Row(ranges.begin() + offsets[row], 
+				ranges.begin() + offsets[row + 1]);
+	}
+	/// number of ranges in all rows
+	size_t rangeCount() const { return ranges.size(); }
+
+	/// start an empty row after the last one
+	void addRow() { offsets.push_back(ranges.size()); }
+	/// add @a range to the end of the last row
+	void push_back(const ScalarRange& range) {
+		assert(!empty());
+		ranges.push_back(range);
+		offsets.back() = ranges.size();
+	}
+	/// add the ranges of @a row to the end of the last row
+	void append(const Row& row) {
+		assert(!empty());
+		ranges.insert(ranges.end(), row.begin(), row.end());
+		offsets.back() = ranges.size();
+	}
+	/// drop the rows past @a rowCount, or add empty rows up to it
+	void resize(size_t rowCount) {
+		offsets.resize(rowCount + 1, ranges.size());
+		ranges.resize(offsets.back());
+	}
+	void reserve(size_t rowCount, size_t rangeCount) {
+		offsets.reserve(rowCount + 1);
+		ranges.reserve(rangeCount);
+	}
+	/// no rows, keeping the memory for reuse
+	void clear() {
+		ranges.clear();
+		offsets.resize(1);
+	}
+	void swap(ScalarRangeTable& other) {
+		ranges.swap(other.ranges);
+		offsets.swap(other.offsets);
+	}
+private:
+	std::vector<ScalarRange> ranges; //< every row, from the first
+	std::vector<size_t> offsets; //< row i is ranges[offsets[i], offsets[i + 1])
+};
 
+/**
+ @brief Every @a stride th row of a ScalarRangeTable from row @a offset, 
+ without a copy
+ 
+ The view has as many rows as the table. The rows it leaves out read as 
+ empty, just as if the selected rows had been copied into a table with 
+ the others left empty. A table converts to a view of all its rows, so 
+ functions taking a view accept tables as well. The view is only valid 
+ while the table is alive and unchanged.
+ */
+class ScalarRangeTableView {
+public:
+	typedef ScalarRangeTable::Row Row;
+
+	ScalarRangeTableView(const ScalarRangeTable& viewed, 
+			size_t rowStride = 1, size_t firstRow = 0) 
+			: table(&viewed), stride(rowStride ? rowStride : 1), 
+			offset(firstRow) {}
+	/// number of rows, including the ones left out
+	size_t size() const { return table->size(); }
+	bool empty() const { return table->empty(); }
+	bool selected(size_t row) const {
+		return row >= offset && (row - offset) % stride == 0;
+	}
+	Row operator[](size_t row) const {
+		Row tableRow = (*table)[row];
+		return selected(row) ? tableRow : Row(tableRow.end(), tableRow.end());
+	}
+	/// number of ranges in the selected rows
+	size_t rangeCount() const {
+		if (stride == 1 && offset == 0)
+			return table->rangeCount();
+		size_t count = 0;
+		for (size_t row = offset; row < size(); row += stride)
+			count += (*table)[row].size();
+		return count;
+	}
+private:
+	const ScalarRangeTable* table;
+	size_t stride;
+	size_t offset;
+};
 
 class GridRanges {
 public:
     ScalarRangeTable xRays;
     ScalarRangeTable yRays;
 	size_t xRaysCount() const {
-		size_t accum = 0;
-		for(size_t i=0; i<xRays.size(); ++i)
-			accum+=xRays[i].size();
-		return accum;
+		return xRays.rangeCount();
 	}
 	size_t yRaysCount() const {
-		size_t accum = 0;
-		for(size_t i=0; i<yRays.size(); ++i)
-			accum+=yRays[i].size();
-		return accum;
+		return yRays.rangeCount();
 	}
 	size_t raysCount() const {
 		return xRaysCount() + yRaysCount();
 	}
 };
 
+/**
+ @brief GridRanges seen through a ScalarRangeTableView in each direction, 
+ as Grid::subSample gives without copying
+ */
+class GridRangesView {
+public:
+	ScalarRangeTableView xRays;
+	ScalarRangeTableView yRays;
+	GridRangesView(const GridRanges& ranges, 
+			size_t stride = 1, size_t offset = 0) 
+			: xRays(ranges.xRays, stride, offset), 
+			yRays(ranges.yRays, stride, offset) {}
+};
+
 bool intersectRange(Scalar a, Scalar b, Scalar c, 
 		Scalar d, Scalar &begin, Scalar &end);
 std::vector< ScalarRange >::const_iterator  subRangeTersect( 
@@ -78,8 +212,8 @@ std::vector< ScalarRange >::const_iterator  subRangeTersect(
 		std::vector< ScalarRange >::const_iterator it,
 		std::vector< ScalarRange >::const_iterator itEnd,
 		std::vector< ScalarRange > &result );
-void rangeTersection(const std::vector< ScalarRange > &oneLine,
-		const std::vector< ScalarRange > &twoLine,
+void rangeTersection(const ScalarRangeTable::Row &oneLine,
+		const ScalarRangeTable::Row &twoLine,
 		std::vector< ScalarRange > &boolLine );
 bool scalarRangeUnion(const ScalarRange& range0, 
 		const ScalarRange& range1, ScalarRange &resultRange);
@@ -88,8 +222,8 @@ std::vector< ScalarRange >::const_iterator  subRangeUnion(
 		std::vector< ScalarRange >::const_iterator it,
 		std::vector< ScalarRange >::const_iterator itEnd,
 		std::vector< ScalarRange > &result );
-void rangeUnion( const std::vector< ScalarRange > &firstLine,
-		const std::vector< ScalarRange > &secondLine,
+void rangeUnion( const ScalarRangeTable::Row &firstLine,
+		const ScalarRangeTable::Row &secondLine,
 		std::vector< ScalarRange > &unionLine );
 bool scalarRangeDifference(const ScalarRange& diffRange,
 		ScalarRange& srcRange,
@@ -99,17 +233,17 @@ std::vector< ScalarRange >::const_iterator  subRangeDifference(
 		std::vector< ScalarRange >::const_iterator it,
 		std::vector< ScalarRange >::const_iterator itEnd,
 		std::vector< ScalarRange > &result );
-void rangeDifference(const std::vector< ScalarRange > &srcLine,
-		const std::vector< ScalarRange > &delLine,
+void rangeDifference(const ScalarRangeTable::Row &srcLine,
+		const ScalarRangeTable::Row &delLine,
 		std::vector< ScalarRange > &diffLine );
-void rangeTableDifference(const ScalarRangeTable &src,
-		const ScalarRangeTable &del,
+void rangeTableDifference(const ScalarRangeTableView &src,
+		const ScalarRangeTableView &del,
 		ScalarRangeTable &diff);
-void rangeTableIntersection(const ScalarRangeTable &a,
-		const ScalarRangeTable &b,
+void rangeTableIntersection(const ScalarRangeTableView &a,
+		const ScalarRangeTableView &b,
 		ScalarRangeTable &result);
-void rangeTableUnion(const ScalarRangeTable &a,
-		const ScalarRangeTable &b,
+void rangeTableUnion(const ScalarRangeTableView &a,
+		const ScalarRangeTableView &b,
 		ScalarRangeTable &result);
 void rayCastAlongX(const std::list<Loop>& outlineLoops,
 		Scalar y,
@@ -121,6 +255,7 @@ void rayCastAlongY(const std::list<Loop>& outlineLoops,
 		Scalar yMin,
 		Scalar yMax,
 		std::vector<ScalarRange> &ranges);
+/// @a yValues, or @a values for rays along y, must be increasing
 void castRaysOnSliceAlongX(const std::list<Loop>& outlineLoops,
 		const std::vector<Scalar> &yValues,
 		Scalar xMin,
@@ -179,37 +314,43 @@ public:
     /// @param result: returned grid post-subsampling
     void subSample(const GridRanges &srcGridRanges, size_t skipCount, 
 			GridRanges &result) const;
+	/// the same selection of lines as a view of @a srcGridRanges, which 
+	/// must outlive it
+	GridRangesView subSample(const GridRanges &srcGridRanges, 
+			size_t skipCount) const;
 
     /// Takes a gridRange and converts that into Polygons that can be used to generate
     /// gcode.
-    void pathsFromRanges(const GridRanges &gridRanges,
+    void pathsFromRanges(const GridRangesView &gridRanges,
 						 const LoopList &outline,
 						 const bool xDirection, OpenPathList &paths) const;
 
     /// joins a/b grid ranges into
-    void gridRangeUnion(const GridRanges& a, const GridRanges &b, 
+    void gridRangeUnion(const GridRangesView& a, const GridRangesView &b, 
 			GridRanges &result) const;
 
 	/// subtracts GridRagne diff from GridRange src to return result grid range
-    void gridRangeDifference(const GridRanges& src, const GridRanges &diff, 
+    void gridRangeDifference(const GridRangesView& src, 
+			const GridRangesView &diff, 
 			GridRanges &result) const;
 
 	/// returns a gridrange that is the interesction of a/b
-    void gridRangeIntersection(const GridRanges& a, const GridRanges &b, 
+    void gridRangeIntersection(const GridRangesView& a, 
+			const GridRangesView &b, 
 			GridRanges &result) const;
 
     /// removes all grid ranges shorter than toleranne 'cutOff', returns a new
     /// simplified grid range
-    void trimGridRange(const GridRanges& src, Scalar cutOff, 
+    void trimGridRange(const GridRangesView& src, Scalar cutOff, 
 			GridRanges &result) const;
 
-	void gridRangesToOpenPaths(const ScalarRangeTable &rays,
+	void gridRangesToOpenPaths(const ScalarRangeTableView &rays,
 							   const std::vector<Scalar> &values,
 							   const axis_e axis,
 							   OpenPathList &paths) const;
 };
 
-void dumpRangeTable(const ScalarRangeTable &table);
+void dumpRangeTable(const ScalarRangeTableView &table);
 
 }
 
@@ -10,6 +10,7 @@
 
 #include "spacial_data.h"
 #include <stdlib.h>
+#include <cmath>
 
 namespace mgl {
 
@@ -57,7 +58,26 @@ public:
                 l_equ : l_gre);
         int x = x1 + x2;
         int y = y1 + y2;
-        return (abs(x) < 2 && abs(y) < 2);
+        if(abs(x) >= 2 || abs(y) >= 2)
+            return false;
+        
+        //the box must also reach the line through the segment, which 
+        //matters for long diagonal segments with boxes near their middle.
+        //Boxes within a hair of the line pass, so no segment that 
+        //intersects this one is lost to rounding
+        Scalar tolerance = (fabs(myData.b.x - myData.a.x) + 
+                fabs(myData.b.y - myData.a.y)) * 1e-6;
+        Scalar corners[4] = { myData.testLeft(bb.bottom_left()), 
+                myData.testLeft(bb.bottom_right()), 
+                myData.testLeft(bb.top_left()), 
+                myData.testLeft(bb.top_right()) };
+        bool left = true;
+        bool right = true;
+        for(int corner = 0; corner < 4; ++corner) {
+            left = left && corners[corner] > tolerance;
+            right = right && corners[corner] < -tolerance;
+        }
+        return !left && !right;
     }
 protected:
     Segment2Type myData;
@@ -0,0 +1,189 @@
+/*
+ * File:   layer_arena.h
+ * Author: Dev
+ *
+ * Per-layer bump allocation for short lived geometry containers
+ */
+
+#ifndef LAYER_ARENA_H
+#define	LAYER_ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <utility>
+
+namespace mgl {
+
+/**
+ @brief Bump allocator whose memory is returned all at once
+
+ Memory handed out by a LayerArena is never freed individually. Instead,
+ release() makes all of it available again in one step. The blocks
+ themselves are kept so that processing the next layer does not touch the
+ heap once the arena has grown to the size of a typical layer.
+
+ Everything allocated from an arena must be destroyed before release()
+ is called. A LayerArena is not thread safe, use one per thread.
+ */
+class LayerArena {
+public:
+	static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+	explicit LayerArena(size_t blockSize = DEFAULT_BLOCK_SIZE)
+			: myBlockSize(blockSize), currentBlock(0),
+			cursor(NULL), limit(NULL), bytesUsed(0) {}
+	~LayerArena() {
+		for(block_list::iterator iter = blocks.begin();
+				iter != blocks.end();
+				++iter) {
+			::operator delete(iter->first);
+		}
+	}
+	/**
+	 @brief get storage for @a bytes, aligned to @a alignment
+	 @param bytes how many bytes to get
+	 @param alignment must be a power of two
+	 @return pointer to storage, valid until release()
+	 */
+	void* allocate(size_t bytes, size_t alignment) {
+		char* result = align(cursor, alignment);
+		while(cursor == NULL || result + bytes > limit) {
+			nextBlock(bytes + alignment);
+			result = align(cursor, alignment);
+		}
+		cursor = result + bytes;
+		bytesUsed += bytes;
+		return result;
+	}
+	/**
+	 @brief make all storage available again, keeping the blocks
+	 */
+	void release() {
+		currentBlock = 0;
+		bytesUsed = 0;
+		if(blocks.empty()) {
+			cursor = limit = NULL;
+		} else {
+			cursor = blocks.front().first;
+			limit = cursor + blocks.front().second;
+		}
+	}
+	/// bytes handed out since the last release()
+	size_t bytesAllocated() const { return bytesUsed; }
+	/// bytes currently held from the heap
+	size_t bytesReserved() const {
+		size_t total = 0;
+		for(block_list::const_iterator iter = blocks.begin();
+				iter != blocks.end();
+				++iter) {
+			total += iter->second;
+		}
+		return total;
+	}
+private:
+	typedef std::vector<std::pair<char*, size_t> > block_list;
+
+	//not copyable, containers hold pointers to us
+	LayerArena(const LayerArena&);
+	LayerArena& operator=(const LayerArena&);
+
+	static char* align(char* ptr, size_t alignment) {
+		size_t address = reinterpret_cast<size_t>(ptr);
+		return reinterpret_cast<char*>((address + alignment - 1) &
+				~(alignment - 1));
+	}
+	void nextBlock(size_t minimum) {
+		//first try to reuse a block kept from before the last release
+		if(cursor != NULL)
+			++currentBlock;
+		while(currentBlock < blocks.size() &&
+				blocks[currentBlock].second < minimum) {
+			++currentBlock;
+		}
+		if(currentBlock == blocks.size()) {
+			size_t size = minimum > myBlockSize ? minimum : myBlockSize;
+			blocks.push_back(std::make_pair(
+					static_cast<char*>(::operator new(size)), size));
+		}
+		cursor = blocks[currentBlock].first;
+		limit = cursor + blocks[currentBlock].second;
+	}
+
+	size_t myBlockSize;
+	block_list blocks;
+	size_t currentBlock;
+	char* cursor;
+	char* limit;
+	size_t bytesUsed;
+};
+
+/**
+ @brief STL allocator drawing from a LayerArena
+
+ A default constructed allocator has no arena and falls back to the
+ global heap, so containers using it behave like ordinary ones unless
+ given an arena at construction. Deallocation from an arena does
+ nothing, the memory comes back when the arena is released.
+ */
+template <typename T>
+class layer_allocator {
+public:
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+
+	template <typename U>
+	struct rebind {
+		typedef layer_allocator<U> other;
+	};
+
+	layer_allocator(LayerArena* arena = NULL) throw() : myArena(arena) {}
+	template <typename U>
+	layer_allocator(const layer_allocator<U>& other) throw()
+			: myArena(other.arena()) {}
+
+	pointer address(reference x) const { return &x; }
+	const_pointer address(const_reference x) const { return &x; }
+
+	pointer allocate(size_type n, const void* = 0) {
+		if(myArena)
+			return static_cast<pointer>(myArena->allocate(n * sizeof(T),
+					ALIGNMENT));
+		return static_cast<pointer>(::operator new(n * sizeof(T)));
+	}
+	void deallocate(pointer p, size_type) {
+		if(!myArena)
+			::operator delete(p);
+	}
+	size_type max_size() const throw() {
+		return size_type(-1) / sizeof(T);
+	}
+	void construct(pointer p, const T& value) { new(p) T(value); }
+	void destroy(pointer p) { p->~T(); }
+
+	LayerArena* arena() const { return myArena; }
+private:
+	static const size_t ALIGNMENT = sizeof(T) < sizeof(double) ?
+		sizeof(double) : 2 * sizeof(double);
+
+	LayerArena* myArena;
+};
+
+template <typename T, typename U>
+bool operator==(const layer_allocator<T>& lhs, const layer_allocator<U>& rhs) {
+	return lhs.arena() == rhs.arena();
+}
+template <typename T, typename U>
+bool operator!=(const layer_allocator<T>& lhs, const layer_allocator<U>& rhs) {
+	return lhs.arena() != rhs.arena();
+}
+
+}
+
+#endif	/* LAYER_ARENA_H */
+
@@ -0,0 +1,216 @@
+/*
+ * File:   layer_bitmap.cc
+ * Author: Dev
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "layer_bitmap.h"
+#include "mgl.h"
+
+namespace mgl {
+
+//directions along cell edges, counterclockwise from +x
+enum { RIGHT, UP, LEFT, DOWN };
+static const long DIRECTION_X[] = { 1, 0, -1, 0 };
+static const long DIRECTION_Y[] = { 0, 1, 0, -1 };
+
+LayerBitmap::LayerBitmap(const ClipperLib::IntRect& bounds,
+		ClipperLib::long64 cell)
+		: left(bounds.left), bottom(bounds.top), cellSize(cell) {
+	if (cellSize <= 0)
+		throw Exception("LayerBitmap cells must have a positive size");
+	columns = (bounds.right - bounds.left) / cellSize + 1;
+	rows = (bounds.bottom - bounds.top) / cellSize + 1;
+	rowWords = (columns + WORD_BITS - 1) / WORD_BITS;
+	cells.assign(rows * rowWords, 0);
+}
+
+void LayerBitmap::draw(const IntLoopList& loops) {
+	//x of every edge crossing the center line of each row
+	std::vector<std::vector<double> > crossings(rows);
+	const double cell = double(cellSize);
+	for (IntLoopList::const_iterator poly = loops.begin();
+			poly != loops.end(); ++poly) {
+		const size_t count = poly->size();
+		for (size_t point = 0; point < count; ++point) {
+			const ClipperLib::IntPoint& a = (*poly)[point];
+			const ClipperLib::IntPoint& b = (*poly)[(point + 1) % count];
+			if (a.Y == b.Y)
+				continue;
+			//rows whose center is in [low, high)
+			const double low = double(std::min(a.Y, b.Y) - bottom);
+			const double high = double(std::max(a.Y, b.Y) - bottom);
+			const long firstRow = std::max(0L,
+					long(std::ceil(low / cell - 0.5)));
+			const long endRow = std::min(long(rows),
+					long(std::ceil(high / cell - 0.5)));
+			const double slope = double(b.X - a.X) / double(b.Y - a.Y);
+			for (long row = firstRow; row < endRow; ++row) {
+				const double y = bottom + (row + 0.5) * cell;
+				crossings[row].push_back(a.X + (y - a.Y) * slope);
+			}
+		}
+	}
+	for (size_t row = 0; row < rows; ++row) {
+		std::vector<double>& line = crossings[row];
+		std::sort(line.begin(), line.end());
+		for (size_t span = 0; span + 1 < line.size(); span += 2) {
+			//columns whose center is in [line[span], line[span + 1])
+			const long first = long(std::ceil(
+					(line[span] - left) / cell - 0.5));
+			const long end = long(std::ceil(
+					(line[span + 1] - left) / cell - 0.5));
+			//spans may run past either side of the frame
+			if (end <= 0 || first >= long(columns))
+				continue;
+			fillSpan(row, std::max(0L, first),
+					std::min(long(columns), end));
+		}
+	}
+}
+
+void LayerBitmap::fillSpan(size_t row, size_t first, size_t end) {
+	if (first >= end)
+		return;
+	word_type* line = &cells[row * rowWords];
+	const size_t firstWord = first / WORD_BITS;
+	const size_t lastWord = (end - 1) / WORD_BITS;
+	const word_type firstMask = ~word_type(0) << (first % WORD_BITS);
+	const word_type lastMask = ~word_type(0) >>
+			(WORD_BITS - 1 - (end - 1) % WORD_BITS);
+	if (firstWord == lastWord) {
+		line[firstWord] |= firstMask & lastMask;
+		return;
+	}
+	line[firstWord] |= firstMask;
+	for (size_t word = firstWord + 1; word < lastWord; ++word)
+		line[word] = ~word_type(0);
+	line[lastWord] |= lastMask;
+}
+
+bool LayerBitmap::empty() const {
+	for (std::vector<word_type>::const_iterator word = cells.begin();
+			word != cells.end(); ++word) {
+		if (*word)
+			return false;
+	}
+	return true;
+}
+
+void LayerBitmap::checkFrame(const LayerBitmap& other) const {
+	if (left != other.left || bottom != other.bottom ||
+			cellSize != other.cellSize ||
+			columns != other.columns || rows != other.rows)
+		throw Exception("LayerBitmap booleans need bitmaps of the same frame");
+}
+
+LayerBitmap& LayerBitmap::operator|=(const LayerBitmap& other) {
+	checkFrame(other);
+	for (size_t word = 0; word < cells.size(); ++word)
+		cells[word] |= other.cells[word];
+	return *this;
+}
+
+LayerBitmap& LayerBitmap::operator&=(const LayerBitmap& other) {
+	checkFrame(other);
+	for (size_t word = 0; word < cells.size(); ++word)
+		cells[word] &= other.cells[word];
+	return *this;
+}
+
+LayerBitmap& LayerBitmap::subtract(const LayerBitmap& other) {
+	checkFrame(other);
+	for (size_t word = 0; word < cells.size(); ++word)
+		cells[word] &= ~other.cells[word];
+	return *this;
+}
+
+bool LayerBitmap::boundary(long x, long y, int direction) const {
+	//the filled cell is on the left of the edge
+	switch (direction) {
+	case RIGHT:
+		return filled(x, y) && !filled(x, y - 1);
+	case UP:
+		return filled(x - 1, y) && !filled(x, y);
+	case LEFT:
+		return filled(x - 1, y - 1) && !filled(x - 1, y);
+	default:
+		return filled(x, y - 1) && !filled(x - 1, y - 1);
+	}
+}
+
+void LayerBitmap::contours(IntLoopList& loops) const {
+	loops.clear();
+	//every loop has a horizontal edge, so starting from unvisited
+	//horizontal edges finds them all. Edge x of row y of corners runs
+	//from corner (x, y) to (x + 1, y).
+	std::vector<char> visited((rows + 1) * columns, 0);
+	for (long y = 0; y <= long(rows); ++y) {
+		for (long x = 0; x < long(columns); ++x) {
+			if (visited[y * columns + x])
+				continue;
+			long startX;
+			int startDirection;
+			if (boundary(x, y, RIGHT)) {
+				startX = x;
+				startDirection = RIGHT;
+			} else if (boundary(x + 1, y, LEFT)) {
+				startX = x + 1;
+				startDirection = LEFT;
+			} else {
+				continue;
+			}
+
+			loops.push_back(ClipperLib::Polygon());
+			ClipperLib::Polygon& loop = loops.back();
+			long cornerX = startX;
+			long cornerY = y;
+			int direction = startDirection;
+			do {
+				if (direction == RIGHT)
+					visited[cornerY * columns + cornerX] = 1;
+				else if (direction == LEFT)
+					visited[cornerY * columns + cornerX - 1] = 1;
+				cornerX += DIRECTION_X[direction];
+				cornerY += DIRECTION_Y[direction];
+				//turn left where two loops meet at a corner, keeping
+				//cells that only touch diagonally apart
+				int next = direction;
+				const int turns[] = { 1, 0, 3 };
+				for (int turn = 0; turn < 3; ++turn) {
+					const int candidate = (direction + turns[turn]) % 4;
+					if (boundary(cornerX, cornerY, candidate)) {
+						next = candidate;
+						break;
+					}
+				}
+				if (next != direction)
+					loop.push_back(ClipperLib::IntPoint(
+							left + cornerX * cellSize,
+							bottom + cornerY * cellSize));
+				direction = next;
+			} while (cornerX != startX || cornerY != y ||
+					direction != startDirection);
+		}
+	}
+}
+
+void bitmapDifference(IntLoopList& dest, const IntLoopList& subject,
+		const IntLoopList& apply, ClipperLib::long64 cell) {
+	ClipperLib::IntRect bounds;
+	if (!loopsBounds(subject, bounds)) {
+		dest.clear();
+		return;
+	}
+	LayerBitmap result(bounds, cell);
+	result.draw(subject);
+	LayerBitmap removed(bounds, cell);
+	removed.draw(apply);
+	result.subtract(removed);
+	result.contours(dest);
+}
+
+}
+
@@ -0,0 +1,99 @@
+/*
+ * File:   layer_bitmap.h
+ * Author: Dev
+ *
+ * Bit packed occupancy of a layer, for booleans at a fixed resolution
+ */
+
+#ifndef LAYER_BITMAP_H
+#define	LAYER_BITMAP_H
+
+#include <vector>
+#include <algorithm>
+
+#include "loop_utils.h"
+#include "clipper.h"
+
+namespace mgl {
+
+/**
+ @brief Cells of a square grid over part of a layer, each filled or empty
+
+ A cell is filled when its center is inside the loops drawn into the
+ bitmap. Rows are packed into machine words, so booleans between bitmaps
+ over the same frame take one word operation per 64 cells no matter how
+ many points the loops had. Coordinates are those of IntLoopList.
+
+ Converting back to loops gives the outlines of the filled cells, with
+ points on cell corners, outer loops counterclockwise and holes clockwise
+ like clipper's results. Cells touching only at a corner end up in
+ separate loops.
+ */
+class LayerBitmap {
+public:
+	typedef ClipperLib::ulong64 word_type;
+
+	LayerBitmap() : left(0), bottom(0), cellSize(1),
+			columns(0), rows(0), rowWords(0) {}
+	/**
+	 @brief an empty bitmap covering @a bounds
+	 @param bounds area to cover, as from loopsBounds
+	 @param cell side of a cell in IntLoopList units, must be positive
+	 */
+	LayerBitmap(const ClipperLib::IntRect& bounds, ClipperLib::long64 cell);
+
+	/// fill the cells inside @a loops, by the even odd rule
+	void draw(const IntLoopList& loops);
+	/// empty all cells
+	void clear() { std::fill(cells.begin(), cells.end(), word_type(0)); }
+	/// whether the cell in @a column and @a row is filled
+	bool filled(long column, long row) const {
+		if (column < 0 || row < 0 ||
+				column >= long(columns) || row >= long(rows))
+			return false;
+		return (cells[row * rowWords + column / WORD_BITS] >>
+				(column % WORD_BITS)) & 1;
+	}
+	bool empty() const;
+	/// outlines of the filled cells
+	void contours(IntLoopList& loops) const;
+
+	/*
+	 Booleans, both bitmaps must cover the same frame or Exception is
+	 thrown
+	 */
+	LayerBitmap& operator|=(const LayerBitmap& other);
+	LayerBitmap& operator&=(const LayerBitmap& other);
+	/// empty the cells filled in @a other
+	LayerBitmap& subtract(const LayerBitmap& other);
+
+	size_t getColumns() const { return columns; }
+	size_t getRows() const { return rows; }
+private:
+	static const size_t WORD_BITS = 64;
+
+	void checkFrame(const LayerBitmap& other) const;
+	void fillSpan(size_t row, size_t first, size_t end);
+	/// whether a boundary leaves corner (x, y) in @a direction
+	bool boundary(long x, long y, int direction) const;
+
+	ClipperLib::long64 left; //< x of the left edge of column 0
+	ClipperLib::long64 bottom; //< y of the bottom edge of row 0
+	ClipperLib::long64 cellSize;
+	size_t columns;
+	size_t rows;
+	size_t rowWords;
+	std::vector<word_type> cells; //< rows from the bottom up
+};
+
+/**
+ @brief @a subject minus @a apply, worked out on a LayerBitmap covering
+ @a subject with cells of side @a cell
+ */
+void bitmapDifference(IntLoopList& dest, const IntLoopList& subject,
+		const IntLoopList& apply, ClipperLib::long64 cell);
+
+}
+
+#endif	/* LAYER_BITMAP_H */
+
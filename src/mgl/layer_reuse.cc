@@ -0,0 +1,205 @@
+/*
+ * File:   layer_reuse.cc
+ * Author: Dev
+ */
+
+#include <list>
+#include <vector>
+
+#include "layer_reuse.h"
+
+namespace mgl {
+
+const LayerReuse::shape_id LayerReuse::NO_SHAPE;
+
+/// FNV-1a over the coordinates of every point, loops kept apart
+static size_t hashLoops(const IntLoopList& loops) {
+	const unsigned long long prime = 1099511628211ULL;
+	unsigned long long hash = 14695981039346656037ULL;
+	for (IntLoopList::const_iterator loop = loops.begin();
+			loop != loops.end(); ++loop) {
+		for (ClipperLib::Polygon::const_iterator point = loop->begin();
+				point != loop->end(); ++point) {
+			hash = (hash ^ (unsigned long long)(point->X)) * prime;
+			hash = (hash ^ (unsigned long long)(point->Y)) * prime;
+		}
+		hash = (hash ^ loop->size()) * prime;
+	}
+	return size_t(hash);
+}
+
+static bool sameLoops(const IntLoopList& lhs, const IntLoopList& rhs) {
+	if (lhs.size() != rhs.size())
+		return false;
+	for (size_t loop = 0; loop < lhs.size(); ++loop) {
+		const ClipperLib::Polygon& left = lhs[loop];
+		const ClipperLib::Polygon& right = rhs[loop];
+		if (left.size() != right.size())
+			return false;
+		for (size_t point = 0; point < left.size(); ++point) {
+			if (left[point].X != right[point].X ||
+					left[point].Y != right[point].Y)
+				return false;
+		}
+	}
+	return true;
+}
+
+LayerReuse::LayerReuse(size_t layerCount, size_t capacity)
+		: myCapacity(capacity), layerShapes(layerCount, NO_SHAPE),
+		nextShape(NO_SHAPE + 1), insetsReused(0), spursReused(0),
+		infillsReused(0) {}
+
+bool LayerReuse::findInsets(size_t layer, LayerRegions& region,
+		Scalar width) {
+	IntLoopList outlines;
+	loopsToIntLoops(region.outlines, outlines);
+	const size_t hash = hashLoops(outlines);
+	bool found = false;
+#ifdef OMPFF
+#pragma omp critical (layerReuse)
+#endif
+	{
+		ShapeList::iterator entry = shapes.begin();
+		while (entry != shapes.end() && (entry->hash != hash ||
+				entry->width != width ||
+				!sameLoops(entry->outlines, outlines)))
+			++entry;
+		if (entry == shapes.end()) {
+			shapes.push_front(ShapeEntry());
+			ShapeEntry& added = shapes.front();
+			added.id = nextShape++;
+			added.hash = hash;
+			added.width = width;
+			added.outlines.swap(outlines);
+			if (shapes.size() > myCapacity)
+				shapes.pop_back();
+		} else {
+			shapes.splice(shapes.begin(), shapes, entry);
+		}
+		const ShapeEntry& current = shapes.front();
+		layerShapes[layer] = current.id;
+		if (current.hasInsets) {
+			region.insetLoops = current.insetLoops;
+			region.interiorLoops = current.interiorLoops;
+			++insetsReused;
+			found = true;
+		}
+	}
+	return found;
+}
+
+void LayerReuse::keepInsets(size_t layer, const LayerRegions& region) {
+#ifdef OMPFF
+#pragma omp critical (layerReuse)
+#endif
+	{
+		ShapeEntry* entry = findShape(layerShapes[layer]);
+		//a layer of the same shape may have got there first
+		if (entry && !entry->hasInsets) {
+			entry->insetLoops = region.insetLoops;
+			entry->interiorLoops = region.interiorLoops;
+			entry->hasInsets = true;
+		}
+	}
+}
+
+bool LayerReuse::findSpurs(size_t layer, LayerRegions& region) {
+	bool found = false;
+#ifdef OMPFF
+#pragma omp critical (layerReuse)
+#endif
+	{
+		const ShapeEntry* entry = findShape(layerShapes[layer]);
+		if (entry && entry->hasSpurs) {
+			region.spurLoops = entry->spurLoops;
+			region.spurs = entry->spurs;
+			++spursReused;
+			found = true;
+		}
+	}
+	return found;
+}
+
+void LayerReuse::keepSpurs(size_t layer, const LayerRegions& region) {
+#ifdef OMPFF
+#pragma omp critical (layerReuse)
+#endif
+	{
+		ShapeEntry* entry = findShape(layerShapes[layer]);
+		if (entry && !entry->hasSpurs) {
+			entry->spurLoops = region.spurLoops;
+			entry->spurs = region.spurs;
+			entry->hasSpurs = true;
+		}
+	}
+}
+
+bool LayerReuse::findInfill(size_t layer, size_t below, size_t above,
+		GridRanges& infill) {
+	bool found = false;
+#ifdef OMPFF
+#pragma omp critical (layerReuse)
+#endif
+	{
+		std::vector<shape_id> around;
+		context(layer, below, above, around);
+		InfillList::iterator entry = infills.begin();
+		while (entry != infills.end() && entry->context != around)
+			++entry;
+		if (layerShapes[layer] != NO_SHAPE && entry != infills.end()) {
+			infills.splice(infills.begin(), infills, entry);
+			infill = entry->infill;
+			++infillsReused;
+			found = true;
+		}
+	}
+	return found;
+}
+
+void LayerReuse::keepInfill(size_t layer, size_t below, size_t above,
+		const GridRanges& infill) {
+#ifdef OMPFF
+#pragma omp critical (layerReuse)
+#endif
+	{
+		std::vector<shape_id> around;
+		context(layer, below, above, around);
+		InfillList::iterator entry = infills.begin();
+		while (entry != infills.end() && entry->context != around)
+			++entry;
+		if (layerShapes[layer] != NO_SHAPE && entry == infills.end()) {
+			infills.push_front(InfillEntry());
+			infills.front().context.swap(around);
+			infills.front().infill = infill;
+			if (infills.size() > myCapacity)
+				infills.pop_back();
+		}
+	}
+}
+
+LayerReuse::ShapeEntry* LayerReuse::findShape(shape_id shape) {
+	if (shape == NO_SHAPE)
+		return NULL;
+	for (ShapeList::iterator entry = shapes.begin();
+			entry != shapes.end(); ++entry) {
+		if (entry->id == shape) {
+			shapes.splice(shapes.begin(), shapes, entry);
+			return &shapes.front();
+		}
+	}
+	return NULL;
+}
+
+void LayerReuse::context(size_t layer, size_t below, size_t above,
+		std::vector<shape_id>& around) const {
+	around.clear();
+	for (size_t offset = 0; offset < below + above + 1; ++offset) {
+		const size_t other = layer + offset - below;
+		//layers under the first wrap around to past the end
+		around.push_back(other < layerShapes.size() ?
+				layerShapes[other] : NO_SHAPE);
+	}
+}
+
+}
@@ -0,0 +1,123 @@
+/*
+ * File:   layer_reuse.h
+ * Author: Dev
+ *
+ * Results of layers already worked out, for layers that would work out
+ * the same
+ */
+
+#ifndef LAYER_REUSE_H
+#define	LAYER_REUSE_H
+
+#include <list>
+#include <vector>
+
+#include "regioner.h"
+#include "loop_utils.h"
+#include "clipper.h"
+
+namespace mgl {
+
+/**
+ @brief Hands results of one layer to later layers of the same shape
+
+ Each layer is given a shape when its insets are looked up. Two layers
+ share a shape only if their outlines are the same point for point in
+ clipper's coordinates, the form every boolean on them starts from, and
+ they extrude the same width. Insets, interiors and spurs depend on
+ nothing else, so a layer can take them from any earlier layer of its
+ shape.
+
+ Infill also depends on the floors and roofs of the layers around it,
+ and so on the shapes of the layers from floorLayerCount below it up to
+ roofLayerCount above it. A layer takes the infill of an earlier one
+ whose layers around it have the same shapes. Layers outside the list or
+ without insets, like rafts, have NO_SHAPE.
+
+ Only the most recently used results are kept, up to a fixed number of
+ each kind, so a model of many different layers costs a bounded amount
+ of memory. Shapes stay distinct after their results are dropped.
+
+ Under OMPFF layers may be looked up and kept from several threads.
+ */
+class LayerReuse {
+public:
+	typedef size_t shape_id;
+	static const shape_id NO_SHAPE = 0;
+
+	/**
+	 @param layerCount number of layers in the region list, layers are
+	 indices into it
+	 @param capacity results of each kind kept at most
+	 */
+	LayerReuse(size_t layerCount, size_t capacity = 16);
+
+	/**
+	 @brief give @a layer its shape from the outlines of @a region, and
+	 copy over insets and interiors if a layer of that shape has them
+	 @param width extrusion width of the layer
+	 @return whether insetLoops and interiorLoops of @a region were set
+	 */
+	bool findInsets(size_t layer, LayerRegions& region, Scalar width);
+	/// keep insets and interiors of @a layer for layers of its shape
+	void keepInsets(size_t layer, const LayerRegions& region);
+	/// @return whether spurLoops and spurs of @a region were set
+	bool findSpurs(size_t layer, LayerRegions& region);
+	void keepSpurs(size_t layer, const LayerRegions& region);
+	/**
+	 @brief copy over infill of an earlier layer whose layers from @a below
+	 under it to @a above over it have the same shapes as those of @a layer
+	 @return whether @a infill was set
+	 */
+	bool findInfill(size_t layer, size_t below, size_t above,
+			GridRanges& infill);
+	void keepInfill(size_t layer, size_t below, size_t above,
+			const GridRanges& infill);
+
+	shape_id shape(size_t layer) const { return layerShapes[layer]; }
+
+	/// how many layers took results of each kind from another layer
+	size_t reusedInsets() const { return insetsReused; }
+	size_t reusedSpurs() const { return spursReused; }
+	size_t reusedInfills() const { return infillsReused; }
+private:
+	struct ShapeEntry {
+		ShapeEntry() : id(NO_SHAPE), hash(0), width(0), 
+				hasInsets(false), hasSpurs(false) {}
+		shape_id id;
+		size_t hash;
+		Scalar width;
+		IntLoopList outlines;
+		bool hasInsets;
+		std::list<LoopList> insetLoops;
+		CachedLoopList interiorLoops;
+		bool hasSpurs;
+		std::list<LoopList> spurLoops;
+		std::list<OpenPathList> spurs;
+	};
+	struct InfillEntry {
+		std::vector<shape_id> context;
+		GridRanges infill;
+	};
+	typedef std::list<ShapeEntry> ShapeList;
+	typedef std::list<InfillEntry> InfillList;
+
+	/// entry of @a shape moved to the front, NULL if it was dropped
+	ShapeEntry* findShape(shape_id shape);
+	/// shapes of the layers from @a below under @a layer to @a above over
+	void context(size_t layer, size_t below, size_t above,
+			std::vector<shape_id>& shapes) const;
+
+	size_t myCapacity;
+	std::vector<shape_id> layerShapes;
+	shape_id nextShape;
+	ShapeList shapes; //< most recently used first
+	InfillList infills; //< most recently used first
+	size_t insetsReused;
+	size_t spursReused;
+	size_t infillsReused;
+};
+
+}
+
+#endif	/* LAYER_REUSE_H */
@@ -0,0 +1,176 @@
+/*
+ * File:   layer_scheduler.cc
+ * Author: Dev
+ */
+
+#include <vector>
+
+#include "layer_scheduler.h"
+#include "mgl.h"
+
+namespace mgl {
+
+LayerScheduler::stage_id LayerScheduler::addStage(Stage& stage,
+		size_t firstLayer, size_t endLayer) {
+	StageInfo info;
+	info.stage = &stage;
+	info.firstLayer = firstLayer;
+	info.endLayer = endLayer < firstLayer ? firstLayer : endLayer;
+	info.firstTask = 0;
+	stages.push_back(info);
+	return stages.size() - 1;
+}
+
+void LayerScheduler::addDependency(stage_id stage, stage_id prerequisite,
+		int firstOffset, int lastOffset) {
+	if(stage >= stages.size() || prerequisite >= stages.size())
+		throw Exception("LayerScheduler dependency on an unknown stage");
+	Dependency dependency;
+	dependency.stage = stage;
+	dependency.prerequisite = prerequisite;
+	dependency.firstOffset = firstOffset;
+	dependency.lastOffset = lastOffset;
+	dependencies.push_back(dependency);
+}
+
+size_t LayerScheduler::taskCount() const {
+	size_t count = 0;
+	for(std::vector<StageInfo>::const_iterator iter = stages.begin();
+			iter != stages.end();
+			++iter) {
+		count += iter->endLayer - iter->firstLayer;
+	}
+	return count;
+}
+
+void LayerScheduler::buildGraph() {
+	const size_t count = taskCount();
+	taskStage.resize(count);
+	size_t task = 0;
+	for(size_t stage = 0; stage < stages.size(); ++stage) {
+		stages[stage].firstTask = task;
+		for(size_t layer = stages[stage].firstLayer;
+				layer < stages[stage].endLayer; ++layer) {
+			taskStage[task++] = stage;
+		}
+	}
+
+	//edges from each prerequisite task to the tasks waiting for it
+	std::vector<std::pair<size_t, size_t> > edges;
+	for(std::vector<Dependency>::const_iterator dependency =
+			dependencies.begin();
+			dependency != dependencies.end();
+			++dependency) {
+		const StageInfo& waiting = stages[dependency->stage];
+		const StageInfo& required = stages[dependency->prerequisite];
+		for(size_t layer = waiting.firstLayer; layer < waiting.endLayer;
+				++layer) {
+			for(int offset = dependency->firstOffset;
+					offset <= dependency->lastOffset; ++offset) {
+				long other = long(layer) + offset;
+				if(other < long(required.firstLayer) ||
+						other >= long(required.endLayer))
+					continue;
+				edges.push_back(std::make_pair(
+						required.firstTask + (other - required.firstLayer),
+						waiting.firstTask + (layer - waiting.firstLayer)));
+			}
+		}
+	}
+
+	pending.assign(count, 0);
+	dependentsBegin.assign(count + 1, 0);
+	for(size_t edge = 0; edge < edges.size(); ++edge) {
+		++dependentsBegin[edges[edge].first + 1];
+		++pending[edges[edge].second];
+	}
+	for(size_t task = 0; task < count; ++task)
+		dependentsBegin[task + 1] += dependentsBegin[task];
+	dependents.resize(edges.size());
+	std::vector<size_t> fill(dependentsBegin.begin(),
+			dependentsBegin.end() - 1);
+	for(size_t edge = 0; edge < edges.size(); ++edge)
+		dependents[fill[edges[edge].first]++] = edges[edge].second;
+
+	//refuse to start on a graph that could never finish
+	std::vector<size_t> waiting(pending);
+	std::vector<size_t> order;
+	order.reserve(count);
+	for(size_t task = 0; task < count; ++task) {
+		if(waiting[task] == 0)
+			order.push_back(task);
+	}
+	for(size_t next = 0; next < order.size(); ++next) {
+		for(size_t edge = dependentsBegin[order[next]];
+				edge < dependentsBegin[order[next] + 1]; ++edge) {
+			if(--waiting[dependents[edge]] == 0)
+				order.push_back(dependents[edge]);
+		}
+	}
+	if(order.size() != count)
+		throw Exception("LayerScheduler stages depend on each other in a cycle");
+}
+
+void LayerScheduler::run() {
+	buildGraph();
+	const size_t count = taskStage.size();
+	readyTasks.clear();
+	for(size_t task = 0; task < count; ++task) {
+		if(pending[task] == 0)
+			readyTasks.push_back(task);
+	}
+#ifdef OMPFF
+	//spawned tasks already count down pending, so only the tasks ready 
+	//from the start are spawned here
+	const size_t startCount = readyTasks.size();
+#pragma omp parallel
+	{
+#pragma omp single
+		{
+			for(size_t next = 0; next < startCount; ++next)
+				spawn(readyTasks[next]);
+		}
+	}
+#else
+	//oldest ready task first, so stages move through the model together
+	for(size_t next = 0; next < readyTasks.size(); ++next)
+		runTask(readyTasks[next]);
+#endif
+	readyTasks.clear();
+	taskStage.clear();
+	pending.clear();
+	dependentsBegin.clear();
+	dependents.clear();
+}
+
+void LayerScheduler::spawn(size_t task) {
+#ifdef OMPFF
+#pragma omp task firstprivate(task)
+	runTask(task);
+#else
+	readyTasks.push_back(task);
+#endif
+}
+
+void LayerScheduler::runTask(size_t task) {
+	const StageInfo& info = stages[taskStage[task]];
+	info.stage->run(info.firstLayer + (task - info.firstTask));
+
+	std::vector<size_t> nowReady;
+#ifdef OMPFF
+#pragma omp critical (layerScheduler)
+#endif
+	{
+		for(size_t edge = dependentsBegin[task];
+				edge < dependentsBegin[task + 1]; ++edge) {
+			if(--pending[dependents[edge]] == 0)
+				nowReady.push_back(dependents[edge]);
+		}
+		if(listener)
+			listener->taskDone();
+	}
+	for(size_t ready = 0; ready < nowReady.size(); ++ready)
+		spawn(nowReady[ready]);
+}
+
+}
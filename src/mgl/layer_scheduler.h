@@ -0,0 +1,109 @@
+/*
+ * File:   layer_scheduler.h
+ * Author: Dev
+ *
+ * Runs per layer work of several stages in dependency order
+ */
+
+#ifndef LAYER_SCHEDULER_H
+#define	LAYER_SCHEDULER_H
+
+#include <cstddef>
+#include <vector>
+#include <utility>
+
+namespace mgl {
+
+/**
+ @brief Runs the per layer tasks of several stages as a dependency graph
+
+ Each stage does its work one layer at a time over a range of layers.
+ A task, one layer of one stage, may depend on a window of layers of
+ other stages, or of its own stage, relative to its own layer. A task
+ runs once every task it depends on has finished, so different stages
+ proceed side by side through the model instead of one whole pass after
+ another.
+
+ Without OMPFF tasks run one at a time in the calling thread. Under OMPFF
+ they are OpenMP tasks run by the current thread pool. Either way the
+ result is the same so long as every stage only reads what its
+ dependencies have written.
+ */
+class LayerScheduler {
+public:
+	/// work of one stage, run once for each layer in the stage's range
+	class Stage {
+	public:
+		virtual ~Stage() {}
+		virtual void run(size_t layer) = 0;
+	};
+	/// called after every task, from one thread at a time
+	class Listener {
+	public:
+		virtual ~Listener() {}
+		virtual void taskDone() = 0;
+	};
+
+	typedef size_t stage_id;
+
+	LayerScheduler() : listener(NULL) {}
+	/**
+	 @brief add a stage running on layers from @a firstLayer up to, but
+	 not including, @a endLayer
+	 @param stage must outlive run()
+	 @return id of the new stage, for use with addDependency
+	 */
+	stage_id addStage(Stage& stage, size_t firstLayer, size_t endLayer);
+	/**
+	 @brief layer i of @a stage waits for layers i + @a firstOffset
+	 through i + @a lastOffset of @a prerequisite
+
+	 Layers outside the range of @a prerequisite are ignored, as is an
+	 empty window. A stage may depend on lower layers of itself to run
+	 them in order.
+	 */
+	void addDependency(stage_id stage, stage_id prerequisite,
+			int firstOffset, int lastOffset);
+	void setListener(Listener* taskListener) { listener = taskListener; }
+	/// number of tasks run() will run
+	size_t taskCount() const;
+	/**
+	 @brief run every task of every stage, then forget the tasks
+
+	 Throws Exception if the dependencies form a cycle.
+	 */
+	void run();
+private:
+	struct StageInfo {
+		Stage* stage;
+		size_t firstLayer;
+		size_t endLayer;
+		size_t firstTask; //< index of the task for firstLayer
+	};
+	struct Dependency {
+		stage_id stage;
+		stage_id prerequisite;
+		int firstOffset;
+		int lastOffset;
+	};
+
+	void buildGraph();
+	void runTask(size_t task);
+	void spawn(size_t task);
+
+	std::vector<StageInfo> stages;
+	std::vector<Dependency> dependencies;
+	Listener* listener;
+
+	//the graph, built by run()
+	std::vector<size_t> taskStage;
+	std::vector<size_t> pending; //< prerequisites not yet finished
+	std::vector<size_t> dependentsBegin; //< index into dependents by task
+	std::vector<size_t> dependents;
+	std::vector<size_t> readyTasks; //< in the order they became ready
+};
+
+}
+
+#endif	/* LAYER_SCHEDULER_H */
+
@@ -166,6 +166,9 @@ public:
 	const_iterator getSuspendedPoints() const { return fromStart(); }; //stub
 	
 	void clear() { points.clear(); endpoints.clear(); }
+	/*! Exchange contents with another path without copying points.
+	 */
+	void swap(OpenPath& other);
 	
 	bool empty() const;
     /**
@@ -470,6 +473,10 @@ public:
 	const_cw_iterator getSuspendedPoints() const;
 	
 	void clear() { pointNormals.clear(); }
+	/*! Exchange contents with another loop without copying points.
+	 *  Iterators into either loop follow the points they refer to.
+	 */
+	void swap(Loop& other);
 	
 	bool empty() const;
     /**
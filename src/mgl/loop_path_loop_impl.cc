@@ -234,6 +234,12 @@ bool Loop::empty() const {
 	return pointNormals.empty();
 }
 
+void Loop::swap(Loop& other) {
+	points.swap(other.points);
+	normals.swap(other.normals);
+	pointNormals.swap(other.pointNormals);
+}
+
 Scalar Loop::distance() const {
     if(empty()) 
         return 0;
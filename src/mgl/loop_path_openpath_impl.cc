@@ -102,6 +102,11 @@ bool OpenPath::empty() const {
 	return points.empty();
 }
 
+void OpenPath::swap(OpenPath& other) {
+	points.swap(other.points);
+	endpoints.swap(other.endpoints);
+}
+
 Scalar OpenPath::distance() const {
     if(empty()) 
         return 0;
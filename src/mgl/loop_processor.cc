@@ -19,24 +19,40 @@ void LoopProcessor::processLoops(const LayerLoops& input, LayerLoops& output) {
         throw Exception("Loop Processor attempted to do in-place processing");
     }
     output.layerMeasure = input.layerMeasure;
-    initProgress("Loop Processing", input.size());
-    
+    size_t first = output.size();
+    output.reserve(first + input.size());
     for(LayerLoops::const_layer_iterator layerIter = input.begin(); 
             layerIter != input.end(); 
             ++layerIter) {
-        const LayerLoops::Layer& currentInputLayer = *layerIter; 
-        LayerLoops::Layer currentOutputLayer(currentInputLayer.getIndex());
-        for(LayerLoops::const_loop_iterator loopIter = currentInputLayer.begin(); 
-                loopIter != currentInputLayer.end(); 
+        output.push_back(*layerIter);
+    }
+    processLayers(output, first);
+}
+
+void LoopProcessor::processLoops(LayerLoops& loops) {
+    processLayers(loops, 0);
+}
+
+void LoopProcessor::processLayers(LayerLoops& loops, size_t first) {
+    const int layerCount = loops.size();
+    initProgress("Loop Processing", layerCount - first);
+    
+    //layers are independent of each other
+#ifdef OMPFF
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for(int layer = first; layer < layerCount; ++layer) {
+        LayerLoops::Layer& currentLayer = loops[layer];
+        for(LayerLoops::loop_iterator loopIter = currentLayer.begin(); 
+                loopIter != currentLayer.end(); 
                 ++loopIter) {
-            Loop processed;
-            smooth(*loopIter, grueCfg.get_preCoarseness(), processed, 
-                    grueCfg.get_directionWeight());
-            currentOutputLayer.push_back(processed);
+            if(grueCfg.get_coarsenessMode() == GrueConfig::COARSENESS_SIMPLIFY)
+                simplify(*loopIter, grueCfg.get_preCoarseness());
+            else
+                smooth(*loopIter, grueCfg.get_preCoarseness(), 
+                        grueCfg.get_directionWeight());
         }
-        
-        output.push_back(currentOutputLayer);
-        tick();
+        tickShared();
     }
 }
 
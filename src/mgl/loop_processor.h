@@ -21,9 +21,17 @@ public:
     LoopProcessor(const GrueConfig& grueConf, ProgressBar* progress = NULL) 
             : Progressive(progress), grueCfg(grueConf) {}
     void processLoops(const LayerLoops& input, LayerLoops& output);
+    /**
+     @brief Process every loop of @a loops in place
+     
+     Gives the same loops as processing into a separate LayerLoops, 
+     without holding a second copy of every layer. Under OMPFF layers are 
+     processed in parallel.
+     */
+    void processLoops(LayerLoops& loops);
 private:
     
-
+    void processLayers(LayerLoops& loops, size_t first);
     
     const GrueConfig& grueCfg;
 };
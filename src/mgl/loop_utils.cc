@@ -1,5 +1,6 @@
 #include <vector>
 #include <algorithm>
+#include <limits>
 
 #include "loop_utils.h"
 #include "clipper.h"
@@ -18,6 +19,10 @@ void IntPointToPoint2Type(const ClipperLib::IntPoint ip, Point2Type &pt) {
 	pt.y = ip.Y / DBLTOINT;
 }
 
+ClipperLib::long64 scalarToIntLength(Scalar length) {
+	return length * DBLTOINT;
+}
+
 
 void loopToClPolygon(const Loop &loop,
 					 ClipperLib::Polygon &clpoly) {
@@ -72,20 +77,258 @@ void ClPolygonToLoop(const ClipperLib::Polygons &clpolys,
 }
 
 
+void loopsToIntLoops(const LoopList& loops, IntLoopList& intLoops) {
+	loopToClPolygon(loops, intLoops);
+}
+
+void intLoopsToLoops(const IntLoopList& intLoops, LoopList& loops) {
+	ClPolygonToLoop(intLoops, loops);
+}
+
+
+static LoopOpStats opStats;
+
+//counters are shared by all threads
+static void countOp(size_t& counter) {
+#ifdef OMPFF
+#pragma omp atomic
+#endif
+	++counter;
+}
+
+//each thread keeps one clipper engine so its buffers are reused
+static ClipperLib::Clipper* localClipper = NULL;
+#ifdef OMPFF
+#pragma omp threadprivate(localClipper)
+#endif
+
+static ClipperLib::Clipper& threadClipper() {
+	if(!localClipper)
+		localClipper = new ClipperLib::Clipper;
+	localClipper->Clear();
+	return *localClipper;
+}
+
+void releaseLoopOpBuffers() {
+	//threadprivate data of the team's threads is only reachable from them
+#ifdef OMPFF
+#pragma omp parallel
+#endif
+	{
+		//the engine returns its records to the pool, so it goes first
+		delete localClipper;
+		localClipper = NULL;
+		ClipperLib::ReleasePooledRecords();
+	}
+}
+
+const LoopOpStats& loopOpStats() {
+	return opStats;
+}
+
+void resetLoopOpStats() {
+	opStats = LoopOpStats();
+}
+
+bool loopsBounds(const IntLoopList& loops, ClipperLib::IntRect& bounds) {
+	bool found = false;
+	for (IntLoopList::const_iterator poly = loops.begin(); 
+			poly != loops.end(); ++poly) {
+		for (ClipperLib::Polygon::const_iterator pt = poly->begin(); 
+				pt != poly->end(); ++pt) {
+			if (!found) {
+				bounds.left = bounds.right = pt->X;
+				bounds.top = bounds.bottom = pt->Y;
+				found = true;
+				continue;
+			}
+			if (pt->X < bounds.left) bounds.left = pt->X;
+			if (pt->X > bounds.right) bounds.right = pt->X;
+			if (pt->Y < bounds.top) bounds.top = pt->Y;
+			if (pt->Y > bounds.bottom) bounds.bottom = pt->Y;
+		}
+	}
+	return found;
+}
+
+void loopsBounds(const IntLoopList& loops, IntLoopBounds& bounds) {
+	bounds.resize(loops.size());
+	IntLoopBounds::iterator box = bounds.begin();
+	for (IntLoopList::const_iterator poly = loops.begin(); 
+			poly != loops.end(); ++poly, ++box) {
+		box->left = box->top = std::numeric_limits<ClipperLib::long64>::max();
+		box->right = box->bottom = 
+				std::numeric_limits<ClipperLib::long64>::min();
+		for (ClipperLib::Polygon::const_iterator pt = poly->begin(); 
+				pt != poly->end(); ++pt) {
+			if (pt->X < box->left) box->left = pt->X;
+			if (pt->X > box->right) box->right = pt->X;
+			if (pt->Y < box->top) box->top = pt->Y;
+			if (pt->Y > box->bottom) box->bottom = pt->Y;
+		}
+	}
+}
+
+//bounds of all loops from the bounds of each, false if there are no points
+static bool totalBounds(const IntLoopBounds& each, 
+		ClipperLib::IntRect& bounds) {
+	bool found = false;
+	for (IntLoopBounds::const_iterator box = each.begin(); 
+			box != each.end(); ++box) {
+		if (box->left > box->right)
+			continue;
+		if (!found) {
+			bounds = *box;
+			found = true;
+			continue;
+		}
+		if (box->left < bounds.left) bounds.left = box->left;
+		if (box->right > bounds.right) bounds.right = box->right;
+		if (box->top < bounds.top) bounds.top = box->top;
+		if (box->bottom > bounds.bottom) bounds.bottom = box->bottom;
+	}
+	return found;
+}
+
+static bool boundsDisjoint(const ClipperLib::IntRect& a, 
+		const ClipperLib::IntRect& b) {
+	return a.right < b.left || b.right < a.left || 
+			a.bottom < b.top || b.bottom < a.top;
+}
+
+/*
+ Taking a loop out of a list changes the area the list covers only within 
+ that loop's bounds, so a loop that touches no loop of the other operand 
+ changes neither a difference it is subtracted by nor an intersection. 
+ Returns @a loops itself if every loop is kept, else @a kept filled with 
+ the loops that are.
+ */
+static const IntLoopList& pruneLoops(const IntLoopList& loops, 
+		const IntLoopBounds& bounds, const IntLoopBounds& others, 
+		const ClipperLib::IntRect& othersTotal, IntLoopList& kept) {
+	std::vector<bool> keep(loops.size(), false);
+	size_t keepCount = 0;
+	for (size_t loop = 0; loop < loops.size(); ++loop) {
+		if (boundsDisjoint(bounds[loop], othersTotal))
+			continue;
+		for (IntLoopBounds::const_iterator other = others.begin(); 
+				other != others.end(); ++other) {
+			if (!boundsDisjoint(bounds[loop], *other)) {
+				keep[loop] = true;
+				++keepCount;
+				break;
+			}
+		}
+	}
+	if (keepCount == loops.size())
+		return loops;
+	for (size_t pruned = loops.size() - keepCount; pruned > 0; --pruned)
+		countOp(opStats.prunedLoops);
+	kept.clear();
+	kept.reserve(keepCount);
+	for (size_t loop = 0; loop < loops.size(); ++loop) {
+		if (keep[loop])
+			kept.push_back(loops[loop]);
+	}
+	return kept;
+}
+
+static void runClipper(IntLoopList &dest, 
+		const IntLoopList &subject, const IntLoopBounds& subjectEach, 
+		const IntLoopList &apply, const IntLoopBounds& applyEach, 
+		const ClipperLib::ClipType type) {
+	//the result is within the bounds of the operands, so empty or disjoint 
+	//operands decide some results without clipper
+	ClipperLib::IntRect subjectBounds, applyBounds;
+	bool subjectEmpty = !totalBounds(subjectEach, subjectBounds);
+	bool applyEmpty = !totalBounds(applyEach, applyBounds);
+	bool disjoint = !subjectEmpty && !applyEmpty && 
+			boundsDisjoint(subjectBounds, applyBounds);
+	
+	const IntLoopList* subjectUsed = &subject;
+	const IntLoopList* applyUsed = &apply;
+	IntLoopList subjectKept, applyKept;
+	const IntLoopList* only = NULL;
+	switch (type) {
+	case ClipperLib::ctIntersection:
+		if (subjectEmpty || applyEmpty) {
+			countOp(opStats.emptyShortcuts);
+			dest.clear();
+			return;
+		}
+		if (!disjoint) {
+			subjectUsed = &pruneLoops(subject, subjectEach, applyEach, 
+					applyBounds, subjectKept);
+			applyUsed = &pruneLoops(apply, applyEach, subjectEach, 
+					subjectBounds, applyKept);
+		}
+		if (disjoint || subjectUsed->empty() || applyUsed->empty()) {
+			countOp(opStats.disjointShortcuts);
+			dest.clear();
+			return;
+		}
+		break;
+	case ClipperLib::ctDifference:
+		if (subjectEmpty) {
+			countOp(opStats.emptyShortcuts);
+			dest.clear();
+			return;
+		}
+		if (!applyEmpty && !disjoint)
+			applyUsed = &pruneLoops(apply, applyEach, subjectEach, 
+					subjectBounds, applyKept);
+		if (applyEmpty || disjoint || applyUsed->empty())
+			only = &subject;
+		break;
+	default:
+		//union and xor
+		if (subjectEmpty && applyEmpty) {
+			countOp(opStats.emptyShortcuts);
+			dest.clear();
+			return;
+		}
+		if (applyEmpty)
+			only = &subject;
+		else if (subjectEmpty)
+			only = &apply;
+		break;
+	}
+	
+	ClipperLib::Clipper& clip = threadClipper();
+	//clipper copies its input, so dest may be the same as subject or apply
+	if (only) {
+		//still run clipper so the result is cleaned up as usual
+		countOp(opStats.singleOperandRuns);
+		clip.AddPolygons(*only, ClipperLib::ptSubject);
+		clip.Execute(ClipperLib::ctUnion, dest);
+		clip.Clear();
+		return;
+	}
+	countOp(opStats.clipperRuns);
+	clip.AddPolygons(*subjectUsed, ClipperLib::ptSubject);
+	clip.AddPolygons(*applyUsed, ClipperLib::ptClip);
+	clip.Execute(type, dest);
+	clip.Clear();
+}
+
+void runClipper(IntLoopList &dest, const IntLoopList &subject, 
+				const IntLoopList &apply, const ClipperLib::ClipType type) {
+	IntLoopBounds subjectEach, applyEach;
+	loopsBounds(subject, subjectEach);
+	loopsBounds(apply, applyEach);
+	runClipper(dest, subject, subjectEach, apply, applyEach, type);
+}
+
 void runClipper(LoopList &dest, const LoopList &subject, const LoopList &apply,
 				const ClipperLib::ClipType type) {
-	ClipperLib::Clipper clip;
-
 	ClipperLib::Polygons clsubject;
 	loopToClPolygon(subject, clsubject);
-	clip.AddPolygons(clsubject, ClipperLib::ptSubject);
 	
 	ClipperLib::Polygons clapply;
 	loopToClPolygon(apply, clapply);
-	clip.AddPolygons(clapply, ClipperLib::ptClip);
 
 	ClipperLib::Polygons cldest;
-	clip.Execute(type, cldest);
+	runClipper(cldest, clsubject, clapply, type);
 
 	ClPolygonToLoop(cldest, dest);
 }	
@@ -134,11 +377,342 @@ void loopsOffset(LoopList& dest, const LoopList& subject, Scalar distance,
 				 bool square) {
 	ClipperLib::Polygons subjectPolys, destPolys;
 	loopToClPolygon(subject, subjectPolys);
-	ClipperLib::OffsetPolygons(subjectPolys, destPolys, distance * DBLTOINT, 
+	loopsOffset(destPolys, subjectPolys, distance, square);
+
+	ClPolygonToLoop(destPolys, dest);
+}
+
+void loopsUnion(IntLoopList &dest,
+				const IntLoopList &subject, const IntLoopList &apply) {
+	runClipper(dest, subject, apply, ClipperLib::ctUnion);
+}
+
+void loopsUnion(IntLoopList &subject, const IntLoopList &apply) {
+	loopsUnion(subject, subject, apply);
+}
+
+
+void loopsDifference(IntLoopList &dest,
+				const IntLoopList &subject, const IntLoopList &apply) {
+	runClipper(dest, subject, apply, ClipperLib::ctDifference);
+}
+
+void loopsDifference(IntLoopList &subject, const IntLoopList &apply) {
+	loopsDifference(subject, subject, apply);
+}
+
+
+void loopsIntersection(IntLoopList &dest,
+				const IntLoopList &subject, const IntLoopList &apply) {
+	runClipper(dest, subject, apply, ClipperLib::ctIntersection);
+}
+
+void loopsIntersection(IntLoopList &subject, const IntLoopList &apply) {
+	loopsIntersection(subject, subject, apply);
+}
+
+
+void loopsXOR(IntLoopList &dest,
+			  const IntLoopList &subject, const IntLoopList &apply) {
+	runClipper(dest, subject, apply, ClipperLib::ctXor);
+}
+
+void loopsXOR(IntLoopList &subject, const IntLoopList &apply) {
+	loopsXOR(subject, subject, apply);
+}
+
+void loopsOffset(IntLoopList& dest, const IntLoopList& subject, 
+				 Scalar distance, bool square) {
+	ClipperLib::OffsetPolygons(subject, dest, distance * DBLTOINT, 
 							   square ? ClipperLib::jtSquare
 							   :ClipperLib::jtMiter, 2.0);
+}
 
-	ClPolygonToLoop(destPolys, dest);
+void loopsOffsetMulti(std::vector<IntLoopList>& dest, 
+					  const IntLoopList& subject, 
+					  const std::vector<Scalar>& distances, 
+					  bool square) {
+	std::vector<double> deltas(distances.size());
+	for(size_t i = 0; i < distances.size(); ++i)
+		deltas[i] = distances[i] * DBLTOINT;
+	ClipperLib::OffsetPolygons(subject, dest, deltas, 
+							   square ? ClipperLib::jtSquare
+							   :ClipperLib::jtMiter, 2.0);
+}
+
+void loopsOffsetMulti(std::vector<LoopList>& dest, 
+					  const LoopList& subject, 
+					  const std::vector<Scalar>& distances, 
+					  bool square) {
+	ClipperLib::Polygons subjectPolys;
+	loopToClPolygon(subject, subjectPolys);
+	std::vector<ClipperLib::Polygons> destPolys;
+	loopsOffsetMulti(destPolys, subjectPolys, distances, square);
+	dest.resize(destPolys.size());
+	for(size_t i = 0; i < destPolys.size(); ++i)
+		ClPolygonToLoop(destPolys[i], dest[i]);
+}
+
+size_t loopsVertexCount(const IntLoopList& loops) {
+	size_t count = 0;
+	for(IntLoopList::const_iterator poly = loops.begin(); 
+			poly != loops.end(); ++poly)
+		count += poly->size();
+	return count;
+}
+
+static Scalar pointX(const Point2Type& point) { return point.x; }
+static Scalar pointY(const Point2Type& point) { return point.y; }
+static Scalar pointX(const ClipperLib::IntPoint& point) { return point.X; }
+static Scalar pointY(const ClipperLib::IntPoint& point) { return point.Y; }
+
+/* Points split into coordinate arrays, so the distance loop in 
+ douglasPeucker works on contiguous memory and can be vectorized. Clipper's 
+ integer coordinates are well within the range a Scalar holds exactly. */
+class SimplifyPoints {
+public:
+    void clear() { xs.clear(); ys.clear(); }
+    template <typename POINT>
+    void push_back(const POINT& point) {
+        xs.push_back(pointX(point));
+        ys.push_back(pointY(point));
+    }
+    size_t size() const { return xs.size(); }
+    Point2Type operator[](size_t index) const { 
+        return Point2Type(xs[index], ys[index]); 
+    }
+    /// no point kept yet, room for the distances of all points
+    void prepare() {
+        distances.resize(size());
+        keep.assign(size(), 0);
+    }
+    
+    std::vector<Scalar> xs;
+    std::vector<Scalar> ys;
+    std::vector<Scalar> distances;
+    std::vector<char> keep;
+    std::vector<std::pair<size_t, size_t> > spans;
+};
+
+/* Mark in points.keep the points Douglas-Peucker keeps of the span from 
+ first to last. Index size() is the first point again, for closed loops. 
+ The tolerance is in the units of the points. */
+static void douglasPeucker(SimplifyPoints& points, size_t first, 
+        size_t last, Scalar tolerance) {
+    const size_t count = points.size();
+    const Scalar* xs = &points.xs[0];
+    const Scalar* ys = &points.ys[0];
+    Scalar* distances = &points.distances[0];
+    const Scalar limit = tolerance * tolerance;
+    points.spans.clear();
+    points.spans.push_back(std::make_pair(first, last));
+    while(!points.spans.empty()) {
+        first = points.spans.back().first;
+        last = points.spans.back().second;
+        points.spans.pop_back();
+        const Scalar ax = xs[first];
+        const Scalar ay = ys[first];
+        const Scalar dx = xs[last % count] - ax;
+        const Scalar dy = ys[last % count] - ay;
+        const Scalar lengthSquared = dx * dx + dy * dy;
+        const Scalar inverse = lengthSquared > 0 ? 1 / lengthSquared : 0;
+        //squared distance of every point in the span to the segment
+        for(size_t i = first + 1; i < last; ++i) {
+            Scalar px = xs[i] - ax;
+            Scalar py = ys[i] - ay;
+            Scalar t = (px * dx + py * dy) * inverse;
+            t = t < 0 ? 0 : (t > 1 ? 1 : t);
+            px -= t * dx;
+            py -= t * dy;
+            distances[i] = px * px + py * py;
+        }
+        size_t worst = first;
+        Scalar worstDistance = limit;
+        for(size_t i = first + 1; i < last; ++i) {
+            if(distances[i] > worstDistance) {
+                worstDistance = distances[i];
+                worst = i;
+            }
+        }
+        if(worst != first) {
+            points.keep[worst] = 1;
+            points.spans.push_back(std::make_pair(first, worst));
+            points.spans.push_back(std::make_pair(worst, last));
+        }
+    }
+}
+
+/* Mark in points.keep the points Douglas-Peucker keeps of a closed ring, 
+ split at its first point and the point farthest from it. Returns how many 
+ are kept, none if all points are the same. */
+static size_t douglasPeuckerRing(SimplifyPoints& points, Scalar tolerance) {
+    const size_t count = points.size();
+    points.prepare();
+    size_t farthest = 0;
+    Scalar farthestDistance = 0;
+    for(size_t i = 1; i < count; ++i) {
+        Scalar dx = points.xs[i] - points.xs[0];
+        Scalar dy = points.ys[i] - points.ys[0];
+        Scalar distance = dx * dx + dy * dy;
+        if(distance > farthestDistance) {
+            farthestDistance = distance;
+            farthest = i;
+        }
+    }
+    if(farthest == 0)
+        return 0;
+    points.keep[0] = 1;
+    points.keep[farthest] = 1;
+    douglasPeucker(points, 0, farthest, tolerance);
+    douglasPeucker(points, farthest, count, tolerance);
+    size_t keptCount = 0;
+    for(size_t i = 0; i < count; ++i)
+        keptCount += points.keep[i];
+    return keptCount;
+}
+
+void loopsSimplify(IntLoopList& loops, Scalar tolerance) {
+	SimplifyPoints points;
+	IntLoopList::iterator kept = loops.begin();
+	for(IntLoopList::iterator poly = loops.begin(); 
+			poly != loops.end(); ++poly) {
+		ClipperLib::Polygon& ring = *poly;
+		if(ring.size() < 3)
+			continue;
+		points.clear();
+		for(ClipperLib::Polygon::const_iterator point = ring.begin(); 
+				point != ring.end(); ++point)
+			points.push_back(*point);
+		if(douglasPeuckerRing(points, tolerance * DBLTOINT) < 3)
+			continue;
+		size_t out = 0;
+		for(size_t i = 0; i < points.size(); ++i) {
+			if(points.keep[i])
+				ring[out++] = ring[i];
+		}
+		ring.resize(out);
+		if(kept != poly)
+			kept->swap(ring);
+		++kept;
+	}
+	loops.erase(kept, loops.end());
+}
+
+void loopsNonZeroUnion(IntLoopList& loops) {
+	if(loops.empty())
+		return;
+	countOp(opStats.singleOperandRuns);
+	ClipperLib::Clipper& clip = threadClipper();
+	clip.AddPolygons(loops, ClipperLib::ptSubject);
+	clip.Execute(ClipperLib::ctUnion, loops, ClipperLib::pftNonZero, 
+			ClipperLib::pftNonZero);
+	clip.Clear();
+}
+
+bool loopsSimplifyToBudget(IntLoopList& loops, size_t budget, 
+		Scalar tolerance) {
+	if(budget == 0 || loopsVertexCount(loops) <= budget)
+		return false;
+	//each try starts from the original loops, so errors do not add up
+	tolerance = std::max(tolerance, 1 / DBLTOINT);
+	IntLoopList simplified;
+	for(;;) {
+		simplified = loops;
+		loopsSimplify(simplified, tolerance);
+		loopsNonZeroUnion(simplified);
+		if(loopsVertexCount(simplified) <= budget)
+			break;
+		tolerance *= 2;
+	}
+	loops.swap(simplified);
+	return true;
+}
+
+CachedLoopList::CachedLoopList() : intLoops(NULL), intBounds(NULL) {}
+
+CachedLoopList::CachedLoopList(const CachedLoopList& other) 
+		: myLoops(other.myLoops), intLoops(NULL), intBounds(NULL) {
+	if(other.intLoops)
+		intLoops = new IntLoopList(*other.intLoops);
+	if(other.intBounds)
+		intBounds = new IntLoopBounds(*other.intBounds);
+}
+
+CachedLoopList& CachedLoopList::operator=(const CachedLoopList& other) {
+	if(this != &other) {
+		myLoops = other.myLoops;
+		dropCache();
+		if(other.intLoops)
+			intLoops = new IntLoopList(*other.intLoops);
+		if(other.intBounds)
+			intBounds = new IntLoopBounds(*other.intBounds);
+	}
+	return *this;
+}
+
+CachedLoopList::~CachedLoopList() {
+	dropCache();
+}
+
+const IntLoopList& CachedLoopList::readIntLoops() const {
+	if(!intLoops) {
+		intLoops = new IntLoopList;
+		loopToClPolygon(myLoops, *intLoops);
+	}
+	return *intLoops;
+}
+
+const IntLoopBounds& CachedLoopList::readIntBounds() const {
+	if(!intBounds) {
+		intBounds = new IntLoopBounds;
+		loopsBounds(readIntLoops(), *intBounds);
+	}
+	return *intBounds;
+}
+
+void CachedLoopList::clear() {
+	LoopList().swap(myLoops);
+	dropCache();
+}
+
+void CachedLoopList::assign(const IntLoopList& source) {
+	//copied first, as source may be the cached form itself
+	IntLoopList* copy = new IntLoopList(source);
+	ClPolygonToLoop(source, myLoops);
+	dropCache();
+	intLoops = copy;
+}
+
+void CachedLoopList::assign(const LoopList& loops) {
+	myLoops = loops;
+	dropCache();
+}
+
+void CachedLoopList::swapLoops(LoopList& loops) {
+	myLoops.swap(loops);
+	dropCache();
+}
+
+void CachedLoopList::dropCache() {
+	delete intLoops;
+	intLoops = NULL;
+	delete intBounds;
+	intBounds = NULL;
+}
+
+void loopsIntersection(IntLoopList &subject, const CachedLoopList &apply) {
+	IntLoopBounds subjectEach;
+	loopsBounds(subject, subjectEach);
+	runClipper(subject, subject, subjectEach, apply.readIntLoops(), 
+			apply.readIntBounds(), ClipperLib::ctIntersection);
+}
+
+void loopsDifference(IntLoopList &dest, 
+		const CachedLoopList &subject, const IntLoopList &apply) {
+	IntLoopBounds applyEach;
+	loopsBounds(apply, applyEach);
+	runClipper(dest, subject.readIntLoops(), subject.readIntBounds(), 
+			apply, applyEach, ClipperLib::ctDifference);
 }
 
 enum SMOOTH_RESULT {
@@ -154,63 +728,78 @@ SMOOTH_RESULT smoothPoints(const Point2Type& lp1,
         Scalar& cumDeviation,
         Point2Type& output);
 
-void smooth(const Loop& input, Scalar smoothness, Loop& output, Scalar factor, 
-        bool recurse) {
-    if(smoothness == 0 || input.size() <= 3) {
-		output = input;
-        return;
-    }
-	Loop::const_finite_cw_iterator current;
-	current = input.clockwiseFinite();
-    
-    typedef std::vector<Point2Type> tmp_collection;
-    tmp_collection tmpPoints;
-    tmpPoints.push_back(*(current++));
-    tmpPoints.push_back(*(current++));
-    
+typedef std::vector<Point2Type> SmoothPointList;
+
+/* One smoothing pass over the points from begin to end, appended to output.
+ There must be more than three points. */
+template <typename ITER, typename END>
+static void smoothPass(ITER current, END end, Scalar smoothness, 
+        Scalar factor, SmoothPointList& output) {
 	//insert the first two points
+    output.push_back(*(current++));
+    output.push_back(*(current++));
     
 	Scalar cumulativeError = 0.0;
     
-	for(; current != input.clockwiseEnd(); ++current) {
-        tmp_collection::reverse_iterator last1 = 
-                tmpPoints.rbegin();
-        tmp_collection::const_reverse_iterator last2 = 
-                tmpPoints.rbegin();
-        ++last2;
+	for(; current != end; ++current) {
         const Point2Type& currentPoint = *current;
-        const Point2Type& lp1 = *last1;
-        const Point2Type& lp2 = *last2;
+        const Point2Type& lp1 = output[output.size() - 1];
+        const Point2Type& lp2 = output[output.size() - 2];
         Point2Type result;
         SMOOTH_RESULT rslt = smoothPoints(lp1, lp2, currentPoint, smoothness, 
                 factor, cumulativeError, result);
         if(rslt == SMOOTH_ADD) {
-            tmpPoints.push_back(currentPoint);
+            output.push_back(currentPoint);
         } else {
-            tmpPoints.back() = result;
+            output.back() = result;
         }
 	}
-    if(recurse) {
-        std::rotate(tmpPoints.begin(), 
-                tmpPoints.begin() + tmpPoints.size() / 2, 
-                tmpPoints.end());
-        
-        Loop tmpLoop;
-        for(std::vector<Point2Type>::const_iterator iter = tmpPoints.begin(); 
-                iter != tmpPoints.end(); 
-                ++iter) {
-            tmpLoop.insertPointBefore(*iter, tmpLoop.clockwiseEnd());
-        }
-        smooth(tmpLoop, smoothness, output, factor, false);
-    } else {
-        for(std::vector<Point2Type>::const_iterator iter = tmpPoints.begin(); 
-                iter != tmpPoints.end(); 
-                ++iter) {
-            output.insertPointBefore(*iter, output.clockwiseEnd());
-        }
+}
+
+/* Smoothed points of a loop with more than three points. With recurse, the 
+ result is rotated halfway and smoothed again so the seam of the first pass 
+ gets smoothed too. The result is left in either first or second, the 
+ return value says which. */
+static const SmoothPointList& smoothLoopPoints(const Loop& input, 
+        Scalar smoothness, Scalar factor, bool recurse, 
+        SmoothPointList& first, SmoothPointList& second) {
+    first.reserve(input.size());
+    smoothPass(input.clockwiseFinite(), input.clockwiseEnd(), smoothness, 
+            factor, first);
+    if(!recurse)
+        return first;
+    std::rotate(first.begin(), first.begin() + first.size() / 2, first.end());
+    if(first.size() <= 3)
+        return first;
+    second.reserve(first.size());
+    smoothPass(first.begin(), first.end(), smoothness, factor, second);
+    return second;
+}
+
+void smooth(const Loop& input, Scalar smoothness, Loop& output, Scalar factor, 
+        bool recurse) {
+    if(smoothness == 0 || input.size() <= 3) {
+		output = input;
+        return;
+    }
+    SmoothPointList first, second;
+    const SmoothPointList& points = smoothLoopPoints(input, smoothness, 
+            factor, recurse, first, second);
+    for(SmoothPointList::const_iterator iter = points.begin(); 
+            iter != points.end(); 
+            ++iter) {
+        output.insertPointBefore(*iter, output.clockwiseEnd());
     }
 }
 
+void smooth(Loop& loop, Scalar smoothness, Scalar factor) {
+    if(smoothness == 0 || loop.size() <= 3)
+        return;
+    Loop output;
+    smooth(loop, smoothness, output, factor);
+    loop.swap(output);
+}
+
 void smooth(const OpenPath& input, Scalar smoothness, OpenPath& output, Scalar factor) {
     if(smoothness == 0 || input.size() <= 3) {
 		output = input;
@@ -247,6 +836,52 @@ void smooth(const OpenPath& input, Scalar smoothness, OpenPath& output, Scalar f
 }
 
 
+void simplify(Loop& loop, Scalar tolerance) {
+    if(tolerance <= 0 || loop.size() <= 3)
+        return;
+    SimplifyPoints points;
+    const Loop& input = loop;
+    for(Loop::const_finite_cw_iterator iter = input.clockwiseFinite(); 
+            iter != input.clockwiseEnd(); 
+            ++iter) {
+        points.push_back(*iter);
+    }
+    const size_t count = points.size();
+    const size_t keptCount = douglasPeuckerRing(points, tolerance);
+    if(keptCount < 3 || keptCount == count)
+        return;
+    Loop output;
+    for(size_t i = 0; i < count; ++i) {
+        if(points.keep[i])
+            output.insertPointBefore(points[i], output.clockwiseEnd());
+    }
+    loop.swap(output);
+}
+
+void simplify(OpenPath& path, Scalar tolerance) {
+    if(tolerance <= 0 || path.size() <= 2)
+        return;
+    SimplifyPoints points;
+    const OpenPath& input = path;
+    for(OpenPath::const_iterator iter = input.fromStart(); 
+            iter != input.end(); 
+            ++iter) {
+        points.push_back(*iter);
+    }
+    const size_t count = points.size();
+    points.prepare();
+    points.keep[0] = 1;
+    points.keep[count - 1] = 1;
+    douglasPeucker(points, 0, count - 1, tolerance);
+    OpenPath output;
+    for(size_t i = 0; i < count; ++i) {
+        if(points.keep[i])
+            output.appendPoint(points[i]);
+    }
+    if(output.size() < count)
+        path.swap(output);
+}
+
 SMOOTH_RESULT smoothPoints(const Point2Type& lp1, 
         const Point2Type& lp2, 
         const Point2Type& cp, 
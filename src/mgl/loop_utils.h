@@ -4,6 +4,19 @@
 #include "loop_path.h"
 #include "labeled_path.h"
 #include <set>
+#include <vector>
+
+namespace ClipperLib {
+/*
+ Only what the declarations below name, so files that do not use clipper 
+ themselves need not include clipper.h. These match clipper.h exactly.
+ */
+typedef signed long long long64;
+struct IntPoint;
+struct IntRect;
+typedef std::vector<IntPoint> Polygon;
+typedef std::vector<Polygon> Polygons;
+}
 
 namespace mgl {
 
@@ -54,12 +67,20 @@ template <template <class, class> class COLLECTION, class T, class ALLOC,
 void stripDuplicates(COLLECTION<T, ALLOC>& collection, 
 		const COMPARE& comp) {
 	std::set<T, COMPARE> uniqueset(comp);
-	typedef typename COLLECTION<T, ALLOC>::iterator iterator;
 	uniqueset.insert(collection.begin(), collection.end());
 	collection.clear();
 	collection.insert(collection.end(), uniqueset.begin(), uniqueset.end());
 }
 
+/**
+ @brief Convex hull of all points of @a input, by Andrew's monotone chain
+ 
+ The hull runs clockwise from the lowest point, leftmost of the lowest, 
+ and ends with that point again. Duplicate points count once and points 
+ in the middle of a hull edge are left out. Turns are tested with the 
+ exact orientation(), so nearly collinear points are never dropped or 
+ kept by rounding. O(n log n) in the number of points.
+ */
 template <template <class, class> class COLLECTION, class ALLOC>
 Loop createConvexLoop(const COLLECTION<Loop, ALLOC>& input){	
 	std::vector<Point2Type> points;
@@ -78,34 +99,41 @@ Loop createConvexLoop(const COLLECTION<Loop, ALLOC>& input){
 				"Attempting convex hull on empty list of loops or empty loops!");
 		throw mixup;
 	}
-	/* Remove duplicates */
-	stripDuplicates(points, AxisFunctor());
-	/* Sort on X */
+	/* Sort on Y, then X, and remove duplicates */
 	std::sort(points.begin(), points.end(), AxisFunctor(Y_AXIS));
+	points.erase(std::unique(points.begin(), points.end()), points.end());
 	
-	Loop retLoop;
-		
-	std::vector<Point2Type>::iterator startIter = points.begin();
-	std::vector<Point2Type>::iterator lastIter = points.begin();
-	
-	retLoop.insertPointBefore(*lastIter, retLoop.clockwiseEnd());
+	/* Left side going up, then right side coming down, keeping only 
+	 clockwise turns */
+	std::vector<Point2Type> hull;
+	hull.reserve(points.size() + 1);
+	for(std::vector<Point2Type>::const_iterator iter = points.begin(); 
+			iter != points.end(); 
+			++iter) {
+		while(hull.size() >= 2 && orientation(hull[hull.size() - 2], 
+				hull.back(), *iter) >= 0)
+			hull.pop_back();
+		hull.push_back(*iter);
+	}
+	const size_t leftSize = hull.size();
+	for(std::vector<Point2Type>::const_reverse_iterator iter = 
+			++points.rbegin(); 
+			iter != points.rend(); 
+			++iter) {
+		while(hull.size() > leftSize && orientation(hull[hull.size() - 2], 
+				hull.back(), *iter) >= 0)
+			hull.pop_back();
+		hull.push_back(*iter);
+	}
+	if(hull.size() == 1)
+		hull.push_back(hull.front());
 	
-	do {
-		std::vector<Point2Type>::iterator bestIter = lastIter;
-		++bestIter;
-		if(bestIter == points.end())
-			bestIter = points.begin();
-		for(std::vector<Point2Type>::iterator iter = points.begin(); 
-				iter != points.end(); 
-				++iter ){
-			if(AngleFunctor(*lastIter).operator ()(
-					*bestIter, *iter)) {
-				bestIter = iter;
-			}
-		}
-		lastIter = bestIter;
-		retLoop.insertPointBefore(*lastIter, retLoop.clockwiseEnd());
-	} while(lastIter != startIter);
+	Loop retLoop;
+	for(std::vector<Point2Type>::const_iterator iter = hull.begin(); 
+			iter != hull.end(); 
+			++iter) {
+		retLoop.insertPointBefore(*iter, retLoop.clockwiseEnd());
+	}
 	return retLoop;
 }
 
@@ -128,9 +156,203 @@ void loopsXOR(LoopList &dest,
 void loopsOffset(LoopList& dest, const LoopList& subject, Scalar distance, 
 				 bool square = true);
 
+/**
+ @brief Loops in the fixed point form clipper works on
+ 
+ Coordinates are scaled by DBLTOINT and wound counterclockwise. A chain of 
+ boolean and offset operations can stay in this form from start to end, 
+ converting from and to LoopList only once instead of at every step.
+ */
+typedef ClipperLib::Polygons IntLoopList;
+
+/*
+ The boolean and offset operations below may be called from several threads 
+ at once. Each thread keeps its own clipper engine and record pool between 
+ calls, so a long run of operations does not rebuild them every time.
+ */
+
+/**
+ @brief Free the clipper engines and record pools of all threads
+ 
+ Call outside any parallel region once a run of operations is over. With 
+ OMPFF each thread of a new parallel region frees its own, which reaches 
+ every thread that ran operations as long as the team size is unchanged.
+ */
+void releaseLoopOpBuffers();
+
+void loopsToIntLoops(const LoopList& loops, IntLoopList& intLoops);
+void intLoopsToLoops(const IntLoopList& intLoops, LoopList& loops);
+/// @a length in Scalar units scaled to IntLoopList units
+ClipperLib::long64 scalarToIntLength(Scalar length);
+
+void loopsUnion(IntLoopList &subject, const IntLoopList &apply);
+void loopsUnion(IntLoopList &dest,
+				const IntLoopList &subject, const IntLoopList &apply);
+
+void loopsDifference(IntLoopList &subject, const IntLoopList &apply);
+void loopsDifference(IntLoopList &dest,
+					 const IntLoopList &subject, const IntLoopList &apply);
+
+void loopsIntersection(IntLoopList &subject, const IntLoopList &apply);
+void loopsIntersection(IntLoopList &dest,
+					   const IntLoopList &subject, const IntLoopList &apply);
+
+void loopsXOR(IntLoopList &subject, const IntLoopList &apply);
+void loopsXOR(IntLoopList &dest,
+			  const IntLoopList &subject, const IntLoopList &apply);
+
+/// @a distance is in Scalar units, it is scaled here
+void loopsOffset(IntLoopList& dest, const IntLoopList& subject, 
+				 Scalar distance, bool square = true);
+
+/**
+ @brief Offset @a subject by each of @a distances at once
+ @param dest resized to match @a distances, dest[i] is offset by distances[i]
+ @param subject loops to offset, must not be an element of @a dest
+ @param distances offsets in Scalar units, in any order
+ @param square join type, as for loopsOffset
+ 
+ Edge normals and areas of @a subject are computed once and shared by all 
+ levels, each level is the same as a separate call to loopsOffset.
+ */
+void loopsOffsetMulti(std::vector<IntLoopList>& dest, 
+					  const IntLoopList& subject, 
+					  const std::vector<Scalar>& distances, 
+					  bool square = true);
+void loopsOffsetMulti(std::vector<LoopList>& dest, 
+					  const LoopList& subject, 
+					  const std::vector<Scalar>& distances, 
+					  bool square = true);
+
+size_t loopsVertexCount(const IntLoopList& loops);
+
+/**
+ @brief Douglas-Peucker simplification of each loop in place
+ @param tolerance most any dropped point may lie from the simplified loop, 
+ in Scalar units
+ 
+ Loops left with fewer than three points are removed. Each loop is 
+ simplified on its own, so topology is not kept: features narrower than 
+ @a tolerance may come out self intersecting and nearby loops may come 
+ out overlapping. The even-odd booleans above do not repair these, use 
+ loopsNonZeroUnion().
+ */
+void loopsSimplify(IntLoopList& loops, Scalar tolerance);
+
+/**
+ @brief Union of @a loops among themselves by the nonzero rule
+ 
+ Untangles self intersecting loops and merges overlapping ones, such as 
+ loopsSimplify() may leave. Holes must wind opposite to the loops around 
+ them, as in any clipper result.
+ */
+void loopsNonZeroUnion(IntLoopList& loops);
+
+/**
+ @brief Simplify @a loops to at most @a budget points
+ @param budget zero means no limit
+ @param tolerance first tolerance to simplify with, in Scalar units
+ @return true if @a loops were simplified
+ 
+ Only loops holding more than @a budget points are simplified. They are 
+ simplified with loopsSimplify() and cleaned up with loopsNonZeroUnion(), 
+ doubling the tolerance until the result fits. Loops too small to keep 
+ three points at the final tolerance are dropped.
+ */
+bool loopsSimplifyToBudget(IntLoopList& loops, size_t budget, 
+		Scalar tolerance);
+
+/**
+ @brief Counts of how boolean operations on loops were evaluated
+ 
+ Operations whose result is known from the operands' bounding boxes skip 
+ clipper entirely, operations where one operand cannot affect the result 
+ run clipper on the other alone. Differences and intersections leave out 
+ each loop whose bounds touch no loop of the other operand, as it cannot 
+ change the result there.
+ */
+struct LoopOpStats {
+	LoopOpStats() : clipperRuns(0), singleOperandRuns(0), 
+			emptyShortcuts(0), disjointShortcuts(0), prunedLoops(0) {}
+	size_t clipperRuns; //< clipper run on both operands
+	size_t singleOperandRuns; //< clipper run on one operand only
+	size_t emptyShortcuts; //< empty result because an operand was empty
+	size_t disjointShortcuts; //< empty result because bounds were disjoint
+	size_t prunedLoops; //< loops left out as they touch no other loop
+};
+
+const LoopOpStats& loopOpStats();
+void resetLoopOpStats();
+
+/**
+ @brief Axis aligned bounds of every point in @a loops
+ @return false if @a loops has no points, @a bounds is then not set
+ */
+bool loopsBounds(const IntLoopList& loops, ClipperLib::IntRect& bounds);
+
+/// bounds of each loop of an IntLoopList, in the same order
+typedef std::vector<ClipperLib::IntRect> IntLoopBounds;
+
+/**
+ @brief Axis aligned bounds of each loop in @a loops
+ 
+ A loop without points gets bounds disjoint from all others.
+ */
+void loopsBounds(const IntLoopList& loops, IntLoopBounds& bounds);
+
+/**
+ @brief A LoopList that remembers its IntLoopList form
+ 
+ The fixed point form and the bounds of its loops are computed on first 
+ use and kept until the loops are replaced through assign(), swapLoops() 
+ or clear(), so loops that take part in many boolean operations are only 
+ converted once per change. The loops are only handed out read only, so 
+ the cached form cannot go stale.
+ */
+class CachedLoopList {
+public:
+	CachedLoopList();
+	CachedLoopList(const CachedLoopList& other);
+	CachedLoopList& operator=(const CachedLoopList& other);
+	~CachedLoopList();
+	/// the loops, reading does not drop the cached form
+	const LoopList& readLoops() const { return myLoops; }
+	/// the loops in fixed point form, converted now if needed
+	const IntLoopList& readIntLoops() const;
+	/// bounds of each loop in fixed point form, measured now if needed
+	const IntLoopBounds& readIntBounds() const;
+	/// set from fixed point loops, which also become the cached form
+	void assign(const IntLoopList& intLoops);
+	void assign(const LoopList& loops);
+	/// exchange the loops with @a loops, drops the cached form
+	void swapLoops(LoopList& loops);
+	
+	/// drop the loops and their cached form, freeing the memory of both
+	void clear();
+	
+	bool empty() const { return myLoops.empty(); }
+	size_t size() const { return myLoops.size(); }
+private:
+	void dropCache();
+	
+	LoopList myLoops;
+	mutable IntLoopList* intLoops; //< NULL until converted
+	mutable IntLoopBounds* intBounds; //< NULL until measured
+};
+
+/*
+ The same as the IntLoopList forms, with the bounds of the cached operand 
+ kept from one operation to the next instead of measured each time.
+ */
+void loopsIntersection(IntLoopList &subject, const CachedLoopList &apply);
+void loopsDifference(IntLoopList &dest, 
+					 const CachedLoopList &subject, const IntLoopList &apply);
+
 void smooth(const Loop& input, Scalar smoothness, Loop& output, Scalar factor = 1.0, 
         bool recurse = true);
 void smooth(const OpenPath& input, Scalar smoothness, OpenPath& output, Scalar factor = 1.0);
+/// smooth @a loop in place, the same as smoothing into a new loop
+void smooth(Loop& loop, Scalar smoothness, Scalar factor = 1.0);
 
 template <typename LOOP_OR_PATH>
 void smooth(LOOP_OR_PATH& input, Scalar smoothness, Scalar factor = 1.0) {
@@ -144,6 +366,30 @@ void smooth(basic_labeled_path<LOOP_OR_PATH>& input, Scalar smoothness, Scalar f
     smooth(input.myPath, smoothness, output, factor);
     input.myPath = output;
 }
+/**
+ @brief Drop points that lie within @a tolerance of the simplified shape
+ 
+ Douglas-Peucker simplification: the Hausdorff distance between the input 
+ and the result is at most @a tolerance, and kept points are not moved. 
+ Loops keep at least three points and paths keep their end points. 
+ Unlike smooth(), the deviation allowed does not accumulate along the path.
+ */
+void simplify(Loop& loop, Scalar tolerance);
+void simplify(OpenPath& path, Scalar tolerance);
+template <typename LOOP_OR_PATH>
+void simplify(basic_labeled_path<LOOP_OR_PATH>& input, Scalar tolerance) {
+    simplify(input.myPath, tolerance);
+}
+template <typename LOOP_OR_PATH_COLLECTION>
+void simplifyCollection(LOOP_OR_PATH_COLLECTION& input, Scalar tolerance) {
+    typedef typename LOOP_OR_PATH_COLLECTION::iterator iterator;
+    for(iterator iter = input.begin();
+            iter != input.end();
+            ++iter) {
+        simplify(*iter, tolerance);
+    }
+}
+
 template <typename LOOP_OR_PATH_COLLECTION>
 void smoothCollection(LOOP_OR_PATH_COLLECTION& input, Scalar smoothness, 
         Scalar factor = 1.0) {
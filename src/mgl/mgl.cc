@@ -16,6 +16,7 @@
 
 #include <stdint.h>
 #include <cstring>
+#include <limits>
 #include <map>
 
 #include <jsoncpp/json/reader.h>
@@ -205,6 +206,79 @@ bool convexVertex(const Point2Type &i, const Point2Type &j, const Point2Type &k)
 	return AreaSign(i, j, k) < 0;
 }
 
+/// a + b as the rounded sum and its rounding error, exactly
+static void twoSum(Scalar a, Scalar b, Scalar& sum, Scalar& error) {
+	sum = a + b;
+	Scalar bPart = sum - a;
+	Scalar aPart = sum - bPart;
+	error = (a - aPart) + (b - bPart);
+}
+
+/// a * b as the rounded product and its rounding error, exactly
+static void twoProduct(Scalar a, Scalar b, Scalar& product, Scalar& error) {
+	//split each factor into halves of 26 bits whose products are exact
+	static const Scalar SPLITTER = 134217729.0; //2^27 + 1
+	product = a * b;
+	Scalar big = SPLITTER * a;
+	Scalar aHigh = big - (big - a);
+	Scalar aLow = a - aHigh;
+	big = SPLITTER * b;
+	Scalar bHigh = big - (big - b);
+	Scalar bLow = b - bHigh;
+	error = aLow * bLow - (((product - aHigh * bHigh) - aLow * bHigh) - 
+			aHigh * bLow);
+}
+
+/**
+ * @returns the sign of (b - a) x (c - a), worked out exactly when the 
+ * rounded value of AreaSign might have the wrong sign
+ */
+int orientation(const Point2Type &a, const Point2Type &b, const Point2Type &c) {
+	Scalar left = (b.x - a.x) * (c.y - a.y);
+	Scalar right = (c.x - a.x) * (b.y - a.y);
+	Scalar det = left - right;
+	//bound on the rounding error of det from Shewchuk's orient2d
+	static const Scalar EPSILON = std::numeric_limits<Scalar>::epsilon() / 2;
+	static const Scalar ERROR_BOUND = (3.0 + 16.0 * EPSILON) * EPSILON;
+	if (std::fabs(det) > ERROR_BOUND * (std::fabs(left) + std::fabs(right)))
+		return det > 0 ? 1 : -1;
+	//every difference and product as an exact sum of two doubles, and 
+	//those summed exactly into terms of increasing magnitude
+	Scalar bx[2], cy[2], cx[2], by[2];
+	twoSum(b.x, -a.x, bx[0], bx[1]);
+	twoSum(c.y, -a.y, cy[0], cy[1]);
+	twoSum(c.x, -a.x, cx[0], cx[1]);
+	twoSum(b.y, -a.y, by[0], by[1]);
+	std::vector<Scalar> terms;
+	for (int i = 0; i < 2; ++i) {
+		for (int j = 0; j < 2; ++j) {
+			Scalar product, error;
+			twoProduct(bx[i], cy[j], product, error);
+			terms.push_back(product);
+			terms.push_back(error);
+			twoProduct(-cx[i], by[j], product, error);
+			terms.push_back(product);
+			terms.push_back(error);
+		}
+	}
+	std::vector<Scalar> expansion;
+	for (std::vector<Scalar>::const_iterator term = terms.begin(); 
+			term != terms.end(); ++term) {
+		Scalar carry = *term;
+		for (std::vector<Scalar>::iterator part = expansion.begin(); 
+				part != expansion.end(); ++part)
+			twoSum(carry, *part, carry, *part);
+		expansion.push_back(carry);
+	}
+	//the largest nonzero term has the sign of the whole sum
+	for (std::vector<Scalar>::reverse_iterator part = expansion.rbegin(); 
+			part != expansion.rend(); ++part) {
+		if (*part != 0)
+			return *part > 0 ? 1 : -1;
+	}
+	return 0;
+}
+
 //std::ostream& mgl::operator << (std::ostream &os, const LineSegment2 &s)
 //{
 //	os << "[ " << s.a << ", " << s.b << "]";
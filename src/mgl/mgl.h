@@ -80,6 +80,10 @@ Scalar AreaSign(const Point2Type& a,
 bool convexVertex(const Point2Type& i,
 		const Point2Type& j,
 		const Point2Type& k);
+/// 1 if a, b, c turn counterclockwise, -1 if clockwise, 0 if collinear
+int orientation(const Point2Type& a,
+		const Point2Type& b,
+		const Point2Type& c);
 
 std::ostream& operator <<(std::ostream& os,
 		const Point2Type& pt);
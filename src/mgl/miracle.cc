@@ -14,6 +14,7 @@ using namespace Json;
 
 
 //// @param slices list of output slice (output )
+//// @param regions emptied layer by layer, see miracle.h
 
 void mgl::miracleGrue(const GrueConfig& grueCfg, 
 		const char *modelFile,
@@ -43,27 +44,25 @@ void mgl::miracleGrue(const GrueConfig& grueCfg,
 	//new interface
 	slicer.generateLoops(segmenter, layerloops);
     
-    LayerLoops processedLoops;
-    
     LoopProcessor processor(grueCfg, progress);
-    processor.processLoops(layerloops, processedLoops);
+    processor.processLoops(layerloops);
     
-    LayerMeasure& layerMeasure = processedLoops.layerMeasure;
+    LayerMeasure& layerMeasure = layerloops.layerMeasure;
 
 
 	Regioner regioner(grueCfg, progress);
+	Pather pather(grueCfg, progress);
+
+	LayerPaths layers;
+	//paths are made from each layer as soon as its regions are done
+	PatherSink patherSink(pather, grueCfg, layerMeasure, grid, layers);
 
 	//old interface
 	//regioner.generateSkeleton(tomograph, regions);
 	//new interface
-	regioner.generateSkeleton(processedLoops, layerMeasure, regions ,
-			limits, grid);
-
-	Pather pather(grueCfg, progress);
-
-	LayerPaths layers;
-	pather.generatePaths(grueCfg, regions,
-						 layerMeasure, grid, layers);
+	regioner.generateSkeleton(layerloops, layerMeasure, regions ,
+			limits, grid, &patherSink);
+	pather.endPaths();
 
 	// pather.writeGcode(gcodeFileStr, modelFile, slices);
 	//std::ofstream gout(gcodeFile);
@@ -104,18 +103,17 @@ void mgl::getSliceJson(const GrueConfig& grueCfg,
 	//new interface
 	slicer.generateLoops(segmenter, layers);
 
-    LayerLoops processed;
-    
     LoopProcessor processor(grueCfg, NULL);
-    processor.processLoops(layers, processed);
+    processor.processLoops(layers);
 
     int thisslice = 0;
 
-    for (LayerLoops::const_layer_iterator layer = processed.begin();
-         layer != processed.end(); ++layer) {
+    for (LayerLoops::const_layer_iterator layer = layers.begin();
+         layer != layers.end(); ++layer) {
         if (thisslice == slicenum) {
             Json::Value loopsval;
-            dumpLoopList(layer->readLoops(), loopsval);
+            LoopList loops(layer->begin(), layer->end());
+            dumpLoopList(loops, loopsval);
 
             Json::StyledWriter writer;
             output << string(writer.write(loopsval)) << endl;
@@ -24,6 +24,13 @@ namespace mgl {
 
 
 
+/**
+ @brief slice @a modelFile and write gcode for it to @a gcodeFile
+ 
+ Layers go on to the pather as the regioner finishes them and are cleared 
+ once nothing reads them, so @a regions is left holding one empty 
+ LayerRegions per layer, not the regions of the model.
+ */
 void miracleGrue(const GrueConfig& grueCfg,
 		const char *modelFile,
 		const char *scadFile,
@@ -38,14 +38,41 @@ namespace mgl {
 using namespace std;
 
 Pather::Pather(const PatherConfig& pCfg, ProgressBar* progress) 
-		: Progressive(progress), patherCfg(pCfg) {}
+		: Progressive(progress), patherCfg(pCfg), stream(NULL) {}
 Pather::Pather(const GrueConfig& grueConf, ProgressBar* progress)
-        : Progressive(progress) {
+        : Progressive(progress), stream(NULL) {
     patherCfg.doGraphOptimization = grueConf.get_doGraphOptimization();
     patherCfg.coarseness = grueConf.get_coarseness();
     patherCfg.directionWeight = grueConf.get_directionWeight();
 }
 
+/// state carried from one layer to the next between beginPaths() and 
+/// endPaths()
+struct Pather::LayerStream {
+	LayerStream(const GrueConfig& cfg, const LayerMeasure& measure, 
+			const Grid& layerGrid, LayerPaths& paths)
+			: grueCfg(cfg), layerMeasure(measure), grid(layerGrid), 
+			layerpaths(paths), firstSliceIdx(0), lastSliceIdx(INT_MAX), 
+			direction(false), currentSlice(0), optimizer(NULL) {}
+	~LayerStream() { delete optimizer; }
+	
+	const GrueConfig& grueCfg;
+	const LayerMeasure& layerMeasure;
+	const Grid& grid;
+	LayerPaths& layerpaths;
+	size_t firstSliceIdx;
+	size_t lastSliceIdx;
+	bool direction;
+	unsigned int currentSlice;
+	//scratch storage for temporaries of one layer, reused for the next
+	LayerArena layerArena;
+	abstract_optimizer* optimizer;
+};
+
+Pather::~Pather() {
+	endPaths();
+}
+
 void Pather::generatePaths(const GrueConfig& grueCfg,
 		const RegionList &skeleton,
 		const LayerMeasure &layerMeasure,
@@ -54,44 +81,76 @@ void Pather::generatePaths(const GrueConfig& grueCfg,
 		int sfirstSliceIdx, // =-1
 		int slastSliceIdx) //
 {
-	size_t firstSliceIdx = 0;
-	size_t lastSliceIdx = INT_MAX;
+	beginPaths(grueCfg, layerMeasure, grid, layerpaths, skeleton.size(), 
+			sfirstSliceIdx, slastSliceIdx);
+	for (RegionList::const_iterator layerRegions = skeleton.begin();
+			layerRegions != skeleton.end(); ++layerRegions) {
+		pathsForLayer(*layerRegions);
+	}
+	endPaths();
+}
+
+void Pather::beginPaths(const GrueConfig& grueCfg,
+		const LayerMeasure &layerMeasure,
+		const Grid &grid,
+		LayerPaths &layerpaths,
+		size_t layerCount,
+		int sfirstSliceIdx, // =-1
+		int slastSliceIdx) //
+{
+	endPaths();
+	stream = new LayerStream(grueCfg, layerMeasure, grid, layerpaths);
+	//one tick per layer, whether the layers come all at once or streamed
+	initProgress("Path generation", layerCount);
 
 	if (sfirstSliceIdx > 0) {
-		firstSliceIdx = (size_t) sfirstSliceIdx;
+		stream->firstSliceIdx = (size_t) sfirstSliceIdx;
 	}
 
 	if (slastSliceIdx > 0) {
-		lastSliceIdx = (size_t) slastSliceIdx;
+		stream->lastSliceIdx = (size_t) slastSliceIdx;
 	}
 
-	bool direction = false;
-	unsigned int currentSlice = 0;
-
-	initProgress("Path generation", skeleton.size());
+	layerpaths.reserve(layerpaths.layerCount() + layerCount);
     
-    abstract_optimizer* optimizer = NULL;
     if(grueCfg.get_doGraphOptimization()) {
-        optimizer = new pather_optimizer_fastgraph(grueCfg);
+        stream->optimizer = new pather_optimizer_fastgraph(grueCfg);
     } else {
-        optimizer = new pather_optimizer();
+        stream->optimizer = new pather_optimizer();
     }
+}
 
-	for (RegionList::const_iterator layerRegions = skeleton.begin();
-			layerRegions != skeleton.end(); ++layerRegions) {
-		tick();
-        try {
-		if (currentSlice < firstSliceIdx) continue;
-		if (currentSlice > lastSliceIdx) break;
-        if(grueCfg.get_doRaft() && currentSlice > 1 && 
-                currentSlice < grueCfg.get_raftLayers() && 
-                grueCfg.get_raftAligned()) {
-            //don't flip direction
-        } else {
-            direction = !direction;
-        }
+void Pather::endPaths() {
+	delete stream;
+	stream = NULL;
+}
+
+void Pather::pathsForLayer(const LayerRegions& layerRegions) {
+	if (stream == NULL)
+		throw Exception("Pather::pathsForLayer called outside beginPaths");
+	const GrueConfig& grueCfg = stream->grueCfg;
+	const LayerMeasure& layerMeasure = stream->layerMeasure;
+	const Grid& grid = stream->grid;
+	LayerPaths& layerpaths = stream->layerpaths;
+	bool& direction = stream->direction;
+	unsigned int& currentSlice = stream->currentSlice;
+	LayerArena& layerArena = stream->layerArena;
+	abstract_optimizer* optimizer = stream->optimizer;
+
+	tick();
+	layerArena.release();
+	try {
+		if (currentSlice < stream->firstSliceIdx) return;
+		if (currentSlice > stream->lastSliceIdx) return;
+		if(grueCfg.get_doRaft() && currentSlice > 1 &&
+				currentSlice < grueCfg.get_raftLayers() &&
+				grueCfg.get_raftAligned()) {
+			//don't flip direction
+		} else {
+			direction = !direction;
+		}
 		const layer_measure_index_t layerMeasureId =
-				layerRegions->layerMeasureId;
+				layerRegions.layerMeasureId;
 
 		//adding these should be handled in gcoder
 		const Scalar z = layerMeasure.getLayerPosition(layerMeasureId);
@@ -108,145 +167,154 @@ void Pather::generatePaths(const GrueConfig& grueCfg,
 				LayerPaths::Layer::ExtruderLayer(grueCfg.get_defaultExtruder()));
 		LayerPaths::Layer::ExtruderLayer& extruderlayer =
 				lp_layer.extruders.back();
-		
+
 //        Json::Value spurLoops;
 //        for(std::list<LoopList>::const_iterator depthIter = 
-//                layerRegions->spurLoops.begin(); 
-//                depthIter != layerRegions->spurLoops.end(); 
+//                layerRegions.spurLoops.begin(); 
+//                depthIter != layerRegions.spurLoops.end(); 
 //                ++depthIter) {
 //            dumpLoopList(*depthIter, spurLoops);
 //        }
 //        std::cerr << Json::FastWriter().write(spurLoops);
-		
+
 		optimizer->clearBoundaries();
-        optimizer->clearPaths();
-
-		const std::list<LoopList>& insetLoops = layerRegions->insetLoops;
-		const std::list<OpenPathList>& spurPaths = layerRegions->spurs;
-		
-        if(grueCfg.get_doOutlines()) {
-            for(LoopList::const_iterator iter = layerRegions->outlines.begin(); 
-                    iter != layerRegions->outlines.end(); 
-                    ++iter) {
-                const LoopPath outlinePath(*iter, iter->clockwise(), 
-                        iter->counterClockwise());
-                extruderlayer.paths.push_back(PathLabel(PathLabel::TYP_OUTLINE, 
-                        PathLabel::OWN_MODEL));
-                OpenPath& path = extruderlayer.paths.back().myPath;
-                for(LoopPath::const_iterator pointIter = outlinePath.fromStart(); 
-                        pointIter != outlinePath.end(); 
-                        ++pointIter) {
-                    path.appendPoint(*pointIter);
-                }
-            }
-            for(LoopList::const_iterator iter = layerRegions->supportLoops.begin(); 
-                    iter != layerRegions->supportLoops.end(); 
-                    ++iter) {
-                const LoopPath outlinePath(*iter, iter->clockwise(), 
-                        iter->counterClockwise());
-                extruderlayer.paths.push_back(PathLabel(PathLabel::TYP_OUTLINE, 
-                        PathLabel::OWN_SUPPORT));
-                OpenPath& path = extruderlayer.paths.back().myPath;
-                for(LoopPath::const_iterator pointIter = outlinePath.fromStart(); 
-                        pointIter != outlinePath.end(); 
-                        ++pointIter) {
-                    path.appendPoint(*pointIter);
-                }
-            }
-        }
-		
-		optimizer->addBoundaries(layerRegions->outlines);	
-        
-        bool hasInfill = grueCfg.get_doInfills() && 
-                grueCfg.get_infillDensity() > 0;
-        bool hasSolidLayers = grueCfg.get_roofLayerCount() > 0 || 
-                grueCfg.get_floorLayerCount() > 0;
-        
-        if(!hasInfill && !hasSolidLayers) {
-            optimizer->addBoundaries(layerRegions->interiorLoops);
-        }
-        
-        const GridRanges& infillRanges = layerRegions->infill;
+		optimizer->clearPaths();
+
+		const std::list<LoopList>& insetLoops = layerRegions.insetLoops;
+		const std::list<OpenPathList>& spurPaths = layerRegions.spurs;
+
+		if(grueCfg.get_doOutlines()) {
+			for(LoopList::const_iterator iter = layerRegions.outlines.begin();
+					iter != layerRegions.outlines.end();
+					++iter) {
+				const LoopPath outlinePath(*iter, iter->clockwise(),
+						iter->counterClockwise());
+				extruderlayer.paths.push_back(PathLabel(PathLabel::TYP_OUTLINE,
+						PathLabel::OWN_MODEL));
+				OpenPath& path = extruderlayer.paths.back().myPath;
+				for(LoopPath::const_iterator pointIter = outlinePath.fromStart();
+						pointIter != outlinePath.end();
+						++pointIter) {
+					path.appendPoint(*pointIter);
+				}
+			}
+			for(LoopList::const_iterator iter = layerRegions.supportLoops.begin();
+					iter != layerRegions.supportLoops.end();
+					++iter) {
+				const LoopPath outlinePath(*iter, iter->clockwise(),
+						iter->counterClockwise());
+				extruderlayer.paths.push_back(PathLabel(PathLabel::TYP_OUTLINE,
+						PathLabel::OWN_SUPPORT));
+				OpenPath& path = extruderlayer.paths.back().myPath;
+				for(LoopPath::const_iterator pointIter = outlinePath.fromStart();
+						pointIter != outlinePath.end();
+						++pointIter) {
+					path.appendPoint(*pointIter);
+				}
+			}
+		}
+
+		optimizer->addBoundaries(layerRegions.outlines);
+
+		bool hasInfill = grueCfg.get_doInfills() &&
+				grueCfg.get_infillDensity() > 0;
+		bool hasSolidLayers = grueCfg.get_roofLayerCount() > 0 ||
+				grueCfg.get_floorLayerCount() > 0;
+
+		if(!hasInfill && !hasSolidLayers) {
+			optimizer->addBoundaries(layerRegions.interiorLoops.readLoops());
+		}
+
+		const GridRanges& infillRanges = layerRegions.infill;
 
-		const std::vector<Scalar>& values = 
+		const std::vector<Scalar>& values =
 				!direction ? grid.getXValues() : grid.getYValues();
 		axis_e axis = direction ? X_AXIS : Y_AXIS;
-        
-        if(grueCfg.get_doRaft() || grueCfg.get_doSupport()) {
-            LoopList outsetSupportLoops;
-            loopsOffset(outsetSupportLoops, layerRegions->supportLoops, 
-                    0.01);
-            optimizer->addBoundaries(outsetSupportLoops);
-            
-            const GridRanges& supportRanges = layerRegions->support;
-            OpenPathList supportPaths;
-            grid.gridRangesToOpenPaths(
-                    direction ? supportRanges.xRays : supportRanges.yRays, 
-                    values, 
-                    axis, 
-                    supportPaths);
-            optimizer->addPaths(supportPaths, PathLabel(PathLabel::TYP_INFILL, 
-                    PathLabel::OWN_SUPPORT, 0));
-        }
+
+		if(grueCfg.get_doRaft() || grueCfg.get_doSupport()) {
+			LoopList outsetSupportLoops;
+			loopsOffset(outsetSupportLoops, layerRegions.supportLoops,
+					0.01);
+			optimizer->addBoundaries(outsetSupportLoops);
+
+			const GridRanges& supportRanges = layerRegions.support;
+			OpenPathList supportPaths;
+			grid.gridRangesToOpenPaths(
+					direction ? supportRanges.xRays : supportRanges.yRays,
+					values,
+					axis,
+					supportPaths);
+			optimizer->addPaths(supportPaths, PathLabel(PathLabel::TYP_INFILL,
+					PathLabel::OWN_SUPPORT, 0));
+		}
 		if(grueCfg.get_doInsets()) {
-            int currentShell = LayerPaths::Layer::ExtruderLayer::INSET_LABEL_VALUE;
-            for(std::list<LoopList>::const_iterator listIter = insetLoops.begin(); 
-                    listIter != insetLoops.end(); 
-                    ++listIter) {
-                int shellVal = currentShell;
-                optimizer->addPaths(*listIter, 
-                        PathLabel(PathLabel::TYP_INSET, 
-                        PathLabel::OWN_MODEL, shellVal));
-                ++currentShell;
-            }
+			int currentShell = LayerPaths::Layer::ExtruderLayer::INSET_LABEL_VALUE;
+			for(std::list<LoopList>::const_iterator listIter = insetLoops.begin();
+					listIter != insetLoops.end();
+					++listIter) {
+				int shellVal = currentShell;
+				optimizer->addPaths(*listIter,
+						PathLabel(PathLabel::TYP_INSET,
+						PathLabel::OWN_MODEL, shellVal));
+				++currentShell;
+			}
 
-            currentShell = LayerPaths::Layer::ExtruderLayer::INSET_LABEL_VALUE;
-            for(std::list<OpenPathList>::const_iterator spurIter = spurPaths.begin(); 
-                spurIter != spurPaths.end(); 
-                    ++spurIter) {
-                int shellVal = currentShell;
-                optimizer->addPaths(*spurIter, 
-                        PathLabel(PathLabel::TYP_INSET, 
-                        PathLabel::OWN_MODEL, shellVal));
-                ++currentShell;
-            }
-        }
+			currentShell = LayerPaths::Layer::ExtruderLayer::INSET_LABEL_VALUE;
+			for(std::list<OpenPathList>::const_iterator spurIter = spurPaths.begin();
+					spurIter != spurPaths.end();
+					++spurIter) {
+				int shellVal = currentShell;
+				optimizer->addPaths(*spurIter,
+						PathLabel(PathLabel::TYP_INSET,
+						PathLabel::OWN_MODEL, shellVal));
+				++currentShell;
+			}
+		}
 
 		OpenPathList infillPaths;
 		grid.gridRangesToOpenPaths(
-				direction ? infillRanges.xRays : infillRanges.yRays,  
-				values, 
-				axis, 
+				direction ? infillRanges.xRays : infillRanges.yRays,
+				values,
+				axis,
 				infillPaths);
-		
-		LabeledOpenPaths preoptimized;
-		
-        if(grueCfg.get_doInfills()) {
-            optimizer->addPaths(infillPaths, PathLabel(PathLabel::TYP_INFILL, 
-                    PathLabel::OWN_MODEL, 
-                    LayerPaths::Layer::ExtruderLayer::INFILL_LABEL_VALUE));
-        }
-        optimizer->optimize(preoptimized);
+
+		layer_allocator<LabeledOpenPath> scratchAlloc(&layerArena);
+		ScratchLabeledPaths preoptimized(scratchAlloc);
+
+		if(grueCfg.get_doInfills()) {
+			optimizer->addPaths(infillPaths, PathLabel(PathLabel::TYP_INFILL,
+					PathLabel::OWN_MODEL,
+					LayerPaths::Layer::ExtruderLayer::INFILL_LABEL_VALUE));
+		}
+		optimizer->optimize(preoptimized);
 //        smoothCollection(preoptimized, grueCfg.get_coarseness(), 
 //                grueCfg.get_directionWeight());
-        cleanPaths(preoptimized);
-        smoothCollection(preoptimized, grueCfg.get_coarseness(), 
-                grueCfg.get_directionWeight());
-        
-        extruderlayer.paths.insert(extruderlayer.paths.end(), 
-                preoptimized.begin(), preoptimized.end());
-        } catch (const std::exception& our) {
-            std::cout << "Error " << our.what() << " on layer " << 
-                    currentSlice << std::endl;
-        }
-		++currentSlice;
+		cleanPaths(preoptimized);
+		if(grueCfg.get_coarsenessMode() == GrueConfig::COARSENESS_SIMPLIFY)
+			simplifyCollection(preoptimized, grueCfg.get_coarseness());
+		else
+			smoothCollection(preoptimized, grueCfg.get_coarseness(),
+					grueCfg.get_directionWeight());
+
+		//hand the optimized paths over without copying their points
+		extruderlayer.paths.reserve(extruderlayer.paths.size() +
+				preoptimized.size());
+		for(ScratchLabeledPaths::iterator iter = preoptimized.begin();
+				iter != preoptimized.end();
+				++iter) {
+			extruderlayer.paths.push_back(LabeledOpenPath(iter->myLabel));
+			extruderlayer.paths.back().myPath.swap(iter->myPath);
+		}
+	} catch (const std::exception& our) {
+		std::cout << "Error " << our.what() << " on layer " <<
+				currentSlice << std::endl;
 	}
-    delete optimizer;
+	++currentSlice;
 }
 
-void Pather::cleanPaths(LabeledOpenPaths& result) {
-    std::vector<LabeledOpenPaths::iterator> eraseMe;
-    typedef LabeledOpenPaths::iterator iterator;
+void Pather::cleanPaths(ScratchLabeledPaths& result) {
+    typedef ScratchLabeledPaths::iterator iterator;
+    std::vector<iterator> eraseMe;
     if(result.empty())
         return;
     iterator current = result.begin();
@@ -18,8 +18,10 @@
 #include "regioner.h"
 #include "loop_path.h"
 #include "labeled_path.h"
+#include "layer_arena.h"
 
 #include <list>
+#include <vector>
 
 namespace mgl {
 
@@ -53,10 +55,17 @@ public:
 	/// for the matching loops[i] boundary for this layer
 };
 
+/**
+ @brief Paths for every layer of a model, in print order
+ 
+ Layers are stored contiguously and may be addressed by index, so the 
+ paths for a layer share the index of the LayerRegions they came from. 
+ Paths within an extruder layer are likewise stored contiguously.
+ */
 class LayerPaths{
 public:
 	class Layer;
-	typedef std::list<Layer> LayerList;
+	typedef std::vector<Layer> LayerList;
 	typedef LayerList::iterator layer_iterator;
 	typedef LayerList::const_iterator const_layer_iterator;
 	
@@ -74,7 +83,7 @@ public:
 			typedef std::list<OpenPathList> InsetList;
 			typedef std::list<OpenPath> InfillList;
 			typedef std::list<OpenPath> OutlineList;
-			typedef std::list<LabeledOpenPath> LabeledPathList;
+			typedef std::vector<LabeledOpenPath> LabeledPathList;
 			typedef InsetList::iterator inset_iterator;
 			typedef InfillList::iterator infill_iterator;
 			typedef OutlineList::iterator outline_iterator;
@@ -117,6 +126,10 @@ public:
 	bool empty() const;
 	size_t layerCount() const;
 	Layer& back();
+	/// access layer at index, undefined if index >= layerCount()
+	Layer& operator [](size_t index);
+	const Layer& operator [](size_t index) const;
+	void reserve(size_t count);
 private:
 	LayerList layers;
 };
@@ -167,9 +180,13 @@ private:
 
 public:
     typedef LayerPaths::Layer::ExtruderLayer::LabeledPathList LabeledOpenPaths;
+    /// per layer scratch list, nodes come from a LayerArena
+    typedef std::list<LabeledOpenPath, layer_allocator<LabeledOpenPath> > 
+            ScratchLabeledPaths;
 
 	Pather(const PatherConfig& pCfg, ProgressBar * progress = NULL);
     Pather(const GrueConfig& grueConf, ProgressBar* progress = NULL);
+    ~Pather();
 
 
 	void generatePaths(const GrueConfig& grueCfg,
@@ -179,6 +196,27 @@ public:
 					   LayerPaths &slices,
 					   int sfirstSliceIdx=-1,
 					   int slastSliceIdx=-1);
+    /**
+     @brief Start generating paths a layer at a time, for regions handed 
+     over as soon as they are finished
+     
+     Each call to pathsForLayer() until endPaths() appends the paths of 
+     the next layer to @a slices, the same as generatePaths would for the 
+     whole list. Arguments must outlive endPaths(). Starts the "Path 
+     generation" progress phase, which each layer then ticks.
+     @param layerCount number of layers to come, used to reserve space and 
+     count progress
+     */
+    void beginPaths(const GrueConfig& grueCfg,
+                    const LayerMeasure &layerMeasure,
+                    const Grid &grid,
+                    LayerPaths &slices,
+                    size_t layerCount,
+                    int sfirstSliceIdx=-1,
+                    int slastSliceIdx=-1);
+    /// paths of the next layer, which may be dropped once this returns
+    void pathsForLayer(const LayerRegions& layerRegions);
+    void endPaths();
     /**
      @brief Drop non-printable paths and join spurs
      @param result the output of optimization that contains discrete 
@@ -192,7 +230,42 @@ public:
      @a result MUST be a list-like type. We will erase iterators from the 
      middle of it.
      */
-	void cleanPaths(LabeledOpenPaths& result);
+	void cleanPaths(ScratchLabeledPaths& result);
+private:
+    /// state carried from one layer to the next between beginPaths() 
+    /// and endPaths()
+    struct LayerStream;
+    LayerStream* stream;
+    
+    Pather(const Pather&);
+    Pather& operator=(const Pather&);
+};
+
+/**
+ @brief Hands each layer the Regioner finishes straight on to a Pather
+ 
+ Paths are appended to @a slices as the layers come. Call endPaths() on 
+ the pather once the Regioner is done.
+ */
+class PatherSink : public RegionSink {
+public:
+    PatherSink(Pather& pather, const GrueConfig& grueCfg, 
+            const LayerMeasure& layerMeasure, const Grid& grid, 
+            LayerPaths& slices) 
+            : myPather(pather), myCfg(grueCfg), myMeasure(layerMeasure), 
+            myGrid(grid), mySlices(slices) {}
+    void startRegions(size_t layerCount) {
+        myPather.beginPaths(myCfg, myMeasure, myGrid, mySlices, layerCount);
+    }
+    void takeRegions(const LayerRegions& regions) {
+        myPather.pathsForLayer(regions);
+    }
+private:
+    Pather& myPather;
+    const GrueConfig& myCfg;
+    const LayerMeasure& myMeasure;
+    const Grid& myGrid;
+    LayerPaths& mySlices;
 };
 
 
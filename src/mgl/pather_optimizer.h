@@ -38,7 +38,13 @@ public:
 	void optimize(LABELEDPATHS<LabeledOpenPath, ALLOC>& labeledpaths) {
 		LabeledOpenPaths result;
 		optimizeInternal(result);
-		labeledpaths.insert(labeledpaths.end(), result.begin(), result.end());
+		//result is ours, take its points rather than copying them
+		for(LabeledOpenPaths::iterator iter = result.begin(); 
+				iter != result.end(); 
+				++iter) {
+			labeledpaths.push_back(LabeledOpenPath(iter->myLabel));
+			labeledpaths.back().myPath.swap(iter->myPath);
+		}
 	}
 	
 	//add paths to optimize
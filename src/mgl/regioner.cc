@@ -11,10 +11,17 @@
 
 #include <list>
 #include <vector>
+#include <algorithm>
 
 #include "regioner.h"
 #include "loop_utils.h"
+#include "sliding_loops_union.h"
+#include "clipper.h"
+#include "layer_scheduler.h"
+#include "layer_bitmap.h"
+#include "layer_reuse.h"
 #include "dump_restore.h"
+#include "log.h"
 
 using namespace mgl;
 using namespace std;
@@ -22,16 +29,192 @@ using namespace libthing;
 
 
 Regioner::Regioner(const GrueConfig& grueConf, ProgressBar* progress)
-        : Progressive(progress), grueCfg(grueConf) {}
+        : Progressive(progress), rasterCellSize(0), spurlessLayers(0), 
+        grueCfg(grueConf) {}
+
+/// what infills carries from one layer to the next
+struct Regioner::InfillWindows {
+	InfillWindows(RegionList::iterator begin, RegionList::iterator end, 
+			LayerReuse* layerReuse = NULL);
+
+	RegionList::iterator regionsBegin;
+	RegionList::iterator regionsEnd;
+	RegionList::iterator roofNext; //< next layer to enter roofs
+	SlidingLoopsUnion floors;
+	SlidingLoopsUnion roofs;
+	/// infill of earlier layers, indexed from regionsBegin, may be NULL
+	LayerReuse* reuse;
+};
 
 static const Scalar LOOP_ERROR_FUDGE_FACTOR = 0.05;
 static const Scalar SUPPORT_FUDGE_FACTOR = 0.02;
 
-void Regioner::generateSkeleton(const LayerLoops& layerloops,
+/// moves the progress bar as scheduled tasks finish
+class Regioner::ProgressTicker : public LayerScheduler::Listener {
+public:
+	ProgressTicker(Regioner& regioner) : myRegioner(regioner) {}
+	void taskDone() { myRegioner.tick(); }
+private:
+	Regioner& myRegioner;
+};
+
+namespace {
+
+/*******
+ * per layer stages of generateSkeleton, layers are indices into the 
+ * region list
+ *******/
+
+class RegionStage : public LayerScheduler::Stage {
+public:
+	RegionStage(Regioner& regioner, RegionList& regions)
+			: myRegioner(regioner), myRegions(regions) {}
+protected:
+	Regioner& myRegioner;
+	RegionList& myRegions;
+};
+
+class InsetsStage : public RegionStage {
+public:
+	InsetsStage(Regioner& regioner, RegionList& regions, 
+			const LayerMeasure& layermeasure, LayerReuse* reuse)
+			: RegionStage(regioner, regions), myMeasure(layermeasure), 
+			myReuse(reuse) {}
+	void run(size_t layer) {
+		LayerRegions& region = myRegions[layer];
+		if (myReuse && myReuse->findInsets(layer, region, 
+				myMeasure.getLayerWidth(region.layerMeasureId)))
+			return;
+		myRegioner.insetsForLayer(region, myMeasure);
+		if (myReuse)
+			myReuse->keepInsets(layer, region);
+	}
+private:
+	const LayerMeasure& myMeasure;
+	LayerReuse* myReuse; //< may be NULL
+};
+
+class SpursStage : public RegionStage {
+public:
+	SpursStage(Regioner& regioner, RegionList& regions, 
+			const LayerMeasure& layermeasure, LayerReuse* reuse)
+			: RegionStage(regioner, regions), myMeasure(layermeasure), 
+			myReuse(reuse) {}
+	void run(size_t layer) {
+		LayerRegions& region = myRegions[layer];
+		if (myReuse && myReuse->findSpurs(layer, region))
+			return;
+		LayerArena spurArena;
+		myRegioner.spursForLayer(region, myMeasure, &spurArena);
+		if (myReuse)
+			myReuse->keepSpurs(layer, region);
+	}
+private:
+	const LayerMeasure& myMeasure;
+	LayerReuse* myReuse; //< may be NULL
+};
+
+class FlatSurfaceStage : public RegionStage {
+public:
+	FlatSurfaceStage(Regioner& regioner, RegionList& regions, 
+			const Grid& grid)
+			: RegionStage(regioner, regions), myGrid(grid) {}
+	void run(size_t layer) {
+		myRegioner.flatSurfaceForLayer(myRegions[layer], myGrid);
+	}
+private:
+	const Grid& myGrid;
+};
+
+class RoofStage : public RegionStage {
+public:
+	RoofStage(Regioner& regioner, RegionList& regions)
+			: RegionStage(regioner, regions) {}
+	void run(size_t layer) {
+		myRegioner.roofForLayer(myRegions[layer], 
+				layer + 1 < myRegions.size() ? &myRegions[layer + 1] : NULL);
+	}
+};
+
+class FloorStage : public RegionStage {
+public:
+	FloorStage(Regioner& regioner, RegionList& regions, size_t firstLayer)
+			: RegionStage(regioner, regions), myFirstLayer(firstLayer) {}
+	void run(size_t layer) {
+		myRegioner.floorForLayer(myRegions[layer], 
+				layer > myFirstLayer ? &myRegions[layer - 1] : NULL);
+	}
+private:
+	size_t myFirstLayer;
+};
+
+class InfillsStage : public RegionStage {
+public:
+	InfillsStage(Regioner& regioner, RegionList& regions, const Grid& grid, 
+			LayerReuse* reuse)
+			: RegionStage(regioner, regions), myGrid(grid), 
+			myWindows(regions.begin(), regions.end(), reuse) {}
+	void run(size_t layer) {
+		myRegioner.infillsForLayer(myWindows, myRegions.begin() + layer, 
+				myGrid);
+	}
+private:
+	const Grid& myGrid;
+	Regioner::InfillWindows myWindows;
+};
+
+class EmitStage : public RegionStage {
+public:
+	EmitStage(Regioner& regioner, RegionList& regions, RegionSink* sink)
+			: RegionStage(regioner, regions), mySink(sink) {}
+	void run(size_t layer) {
+		mySink->takeRegions(myRegions[layer]);
+	}
+private:
+	RegionSink* mySink;
+};
+
+class ReleaseStage : public RegionStage {
+public:
+	ReleaseStage(Regioner& regioner, RegionList& regions)
+			: RegionStage(regioner, regions) {}
+	void run(size_t layer) {
+		myRegions[layer].clear();
+	}
+};
+
+}
+
+static void releaseRanges(GridRanges& ranges) {
+	ScalarRangeTable().swap(ranges.xRays);
+	ScalarRangeTable().swap(ranges.yRays);
+}
+
+void LayerRegions::clear() {
+	outlines.clear();
+	insetLoops.clear();
+	spurLoops.clear();
+	supportLoops.clear();
+	interiorLoops.clear();
+	floorLoops.clear();
+	roofLoops.clear();
+	spurs.clear();
+	releaseRanges(flatSurface);
+	releaseRanges(supportSurface);
+	releaseRanges(roofing);
+	releaseRanges(flooring);
+	releaseRanges(support);
+	releaseRanges(infill);
+	releaseRanges(solid);
+	releaseRanges(sparse);
+}
+
+void Regioner::generateSkeleton(LayerLoops& layerloops,
 		LayerMeasure& layerMeasure,
 		RegionList& regionlist,
 		Limits& limits,
-		Grid& grid) {
+		Grid& grid,
+		RegionSink* sink) {
 //	int debuglayer = 0;
 //	for(LayerLoops::const_layer_iterator layerIter = layerloops.begin(); 
 //			layerIter != layerloops.end(); 
@@ -40,10 +223,16 @@ void Regioner::generateSkeleton(const LayerLoops& layerloops,
 //				<< layerIter->readLoops().size() << std::endl;
 //	}
 	layerMeasure.setLayerWidthRatio(grueCfg.get_layerWidthRatio());
+	resetLoopOpStats();
+	spurlessLayers = 0;
 	RegionList::iterator firstmodellayer;
 	int sliceCount = initRegionList(layerloops, regionlist, layerMeasure,
 			firstmodellayer);
 	roofLengthCutOff = 0.5 * layerMeasure.getLayerW();
+	//raster cells no coarser than the grid infill is sampled on
+	rasterCellSize = layerMeasure.getLayerW() * 
+			grueCfg.get_gridSpacingMultiplier() / 
+			grueCfg.get_rasterOversample();
 
 	if (grueCfg.get_doSupport()) {
 		initProgress("support", sliceCount*2);
@@ -82,37 +271,123 @@ void Regioner::generateSkeleton(const LayerLoops& layerloops,
 			regionlist.begin() + (grueCfg.get_doRaft() ? 
                 grueCfg.get_raftLayers() : 0);
 
-	initProgress("insets", sliceCount);
-	insets(layerloops.begin(), layerloops.end(),
-			firstModelRegion, regionlist.end(),
-			layerMeasure);
-
-    initProgress("spurs", sliceCount);
-    spurs(firstModelRegion, regionlist.end(), layerMeasure);
-
-	initProgress("flat surfaces", sliceCount);
-	flatSurfaces(regionlist.begin(), regionlist.end(), grid);
-
-	initProgress("roofing", sliceCount);
-	roofing(firstModelRegion, regionlist.end(), grid);
-
-	initProgress("flooring", sliceCount);
-	flooring(firstModelRegion, regionlist.end(), grid);
+	//the remaining stages work a layer at a time, each layer waiting only 
+	//for the layers it reads from. Infills is a chain from the bottom up, 
+	//its floor and roof windows slide along with it.
+	const size_t firstModel = firstModelRegion - regionlist.begin();
+	const size_t regionCount = regionlist.size();
+	const int roofCount = grueCfg.get_roofLayerCount();
+	//layers that come out the same as an earlier one take its results
+	LayerReuse reuse(regionCount);
+	LayerReuse* layerReuse = grueCfg.get_doLayerReuse() ? &reuse : NULL;
+	InsetsStage insetsStage(*this, regionlist, layerMeasure, layerReuse);
+	SpursStage spursStage(*this, regionlist, layerMeasure, layerReuse);
+	FlatSurfaceStage flatSurfaceStage(*this, regionlist, grid);
+	RoofStage roofStage(*this, regionlist);
+	FloorStage floorStage(*this, regionlist, firstModel);
+	InfillsStage infillsStage(*this, regionlist, grid, layerReuse);
+
+	LayerScheduler scheduler;
+	LayerScheduler::stage_id insetsId = 
+			scheduler.addStage(insetsStage, firstModel, regionCount);
+	LayerScheduler::stage_id spursId = 
+			scheduler.addStage(spursStage, firstModel, regionCount);
+	LayerScheduler::stage_id flatSurfaceId = 
+			scheduler.addStage(flatSurfaceStage, 0, regionCount);
+	LayerScheduler::stage_id roofId = 
+			scheduler.addStage(roofStage, firstModel, regionCount);
+	LayerScheduler::stage_id floorId = 
+			scheduler.addStage(floorStage, firstModel, regionCount);
+	LayerScheduler::stage_id infillsId = 
+			scheduler.addStage(infillsStage, 0, regionCount);
+
+	scheduler.addDependency(spursId, insetsId, 0, 0);
+	scheduler.addDependency(roofId, insetsId, 0, 1);
+	scheduler.addDependency(roofId, flatSurfaceId, 0, 0);
+	scheduler.addDependency(floorId, insetsId, -1, 0);
+	scheduler.addDependency(infillsId, infillsId, -1, -1);
+	scheduler.addDependency(infillsId, insetsId, 0, 0);
+	scheduler.addDependency(infillsId, flatSurfaceId, 0, 0);
+	scheduler.addDependency(infillsId, floorId, 0, 0);
+	if (roofCount > 0)
+		scheduler.addDependency(infillsId, roofId, 0, roofCount - 1);
+
+	//with a sink, finished layers go to it in order and are cleared once 
+	//nothing reads them. Insets and flat surfaces of a layer wait for the 
+	//layer a window below to be cleared, which keeps the number of layers 
+	//held bounded. Clearing a layer waits on layers at most 
+	//floorCount + roofCount above it, so the window must be wider.
+	const int floorCount = grueCfg.get_floorLayerCount();
+	int workers = 1;
+#ifdef OMPFF
+	workers = omp_get_max_threads();
+#endif
+	const int window = floorCount + roofCount + 1 + workers;
+	EmitStage emitStage(*this, regionlist, sink);
+	ReleaseStage releaseStage(*this, regionlist);
+	if (sink) {
+		LayerScheduler::stage_id emitId = 
+				scheduler.addStage(emitStage, 0, regionCount);
+		LayerScheduler::stage_id releaseId = 
+				scheduler.addStage(releaseStage, 0, regionCount);
+		scheduler.addDependency(emitId, emitId, -1, -1);
+		scheduler.addDependency(emitId, spursId, 0, 0);
+		scheduler.addDependency(emitId, infillsId, 0, 0);
+		//readers of a layer: its neighbours' roofs and floors, and the 
+		//floor windows of the infills above
+		scheduler.addDependency(releaseId, emitId, 0, 0);
+		scheduler.addDependency(releaseId, roofId, -1, -1);
+		scheduler.addDependency(releaseId, floorId, 1, 1);
+		scheduler.addDependency(releaseId, infillsId, 0, floorCount);
+		scheduler.addDependency(insetsId, releaseId, -window, -window);
+		scheduler.addDependency(flatSurfaceId, releaseId, -window, -window);
+	}
 
-	initProgress("infills", sliceCount);
-	infills(regionlist.begin(), regionlist.end(), grid);
+	//a sink reports progress by the layers it is handed, which also 
+	//counts the regions, as layers reach it in order once done
+	ProgressTicker ticker(*this);
+	if (sink) {
+		sink->startRegions(regionCount);
+	} else {
+		scheduler.setListener(&ticker);
+		initProgress("regions", scheduler.taskCount());
+	}
+	scheduler.run();
+	
+	const LoopOpStats& opStats = loopOpStats();
+	Log::fine() << "Loop operations: " << opStats.clipperRuns << " full, " 
+			<< opStats.singleOperandRuns << " single operand, " 
+			<< opStats.emptyShortcuts << " empty, " 
+			<< opStats.disjointShortcuts << " disjoint, " 
+			<< opStats.prunedLoops << " loops pruned" << endl;
+	Log::fine() << "Spurs skipped on " << spurlessLayers << " of " 
+			<< regionCount - firstModel << " layers" << endl;
+	if (layerReuse) {
+		Log::fine() << "Reused insets on " << reuse.reusedInsets() 
+				<< " layers, spurs on " << reuse.reusedSpurs() 
+				<< ", infill on " << reuse.reusedInfills() << endl;
+	}
+	releaseLoopOpBuffers();
 }
 
-size_t Regioner::initRegionList(const LayerLoops& layerloops,
+size_t Regioner::initRegionList(LayerLoops& layerloops,
 		RegionList &regionlist,
 		LayerMeasure& layermeasure,
 		RegionList::iterator& firstmodellayer) {
-	//copy over data from layerloops
-	for (LayerLoops::const_layer_iterator iter = layerloops.begin();
+	//move over data from layerloops
+	regionlist.reserve(regionlist.size() + layerloops.size() + 
+			(grueCfg.get_doRaft() ? grueCfg.get_raftLayers() : 0));
+	for (LayerLoops::layer_iterator iter = layerloops.begin();
 			iter != layerloops.end();
 			++iter) {
-		LayerRegions currentRegions;
-		currentRegions.outlines = iter->readLoops();
+		regionlist.push_back(LayerRegions());
+		LayerRegions& currentRegions = regionlist.back();
+		for (LayerLoops::loop_iterator loopIter = iter->begin(); 
+				loopIter != iter->end(); 
+				++loopIter) {
+			currentRegions.outlines.push_back(Loop());
+			currentRegions.outlines.back().swap(*loopIter);
+		}
 		currentRegions.layerMeasureId = iter->getIndex();
 
 		LayerMeasure::LayerAttributes& currentAttribs =
@@ -125,8 +400,6 @@ size_t Regioner::initRegionList(const LayerLoops& layerloops,
 			//this is not the first layer, make it relative to first
 			currentAttribs.base = regionlist.front().layerMeasureId;
 		}
-
-		regionlist.push_back(currentRegions);
 	}
 
 	firstmodellayer = regionlist.begin();
@@ -262,30 +535,56 @@ void Regioner::insetsForSlice(const LoopList& sliceOutlines,
 							  LoopList &interiors) {
 	const Scalar base_distance = 0.5 * layermeasure.getLayerW();
 
-	for (unsigned int shell = 0; shell < grueCfg.get_nbOfShells(); ++shell) {
-		sliceInsets.push_back(LoopList());
-		LoopList &shells = sliceInsets.back();
+	const Scalar extra = (grueCfg.get_maxSpurWidth() - layermeasure.getLayerW()
+						  + LOOP_ERROR_FUDGE_FACTOR) / 2 ;
+	const unsigned int shellCount = grueCfg.get_nbOfShells();
 
+	//offsets are chained in clipper's form, converting each shell once
+	IntLoopList intOutlines, intShells;
+	loopsToIntLoops(sliceOutlines, intOutlines);
+	
+	//every shell is an offset of the outlines, shells with spurs use mitered 
+	//corners, the rest square ones. Gather the distances for each kind and 
+	//offset the outlines to all of them at once.
+	std::vector<bool> spurShell(shellCount);
+	std::vector<Scalar> miterDistances, squareDistances;
+	for (unsigned int shell = 0; shell < shellCount; ++shell) {
 		Scalar distance = base_distance + grueCfg.get_insetDistanceMultiplier()
 			* layermeasure.getLayerW() * shell;
+		spurShell[shell] = (shell == 0 && grueCfg.get_doExternalSpurs()) ||
+			(shell > 0 && grueCfg.get_doInternalSpurs());
+		if (spurShell[shell])
+			miterDistances.push_back(-(distance + extra));
+		else
+			squareDistances.push_back(-distance);
+	}
+	std::vector<IntLoopList> miterOffsets, squareOffsets;
+	if (!miterDistances.empty())
+		loopsOffsetMulti(miterOffsets, intOutlines, miterDistances, false);
+	if (!squareDistances.empty())
+		loopsOffsetMulti(squareOffsets, intOutlines, squareDistances);
+	
+	std::vector<IntLoopList>::iterator miterShell = miterOffsets.begin();
+	std::vector<IntLoopList>::iterator squareShell = squareOffsets.begin();
+	for (unsigned int shell = 0; shell < shellCount; ++shell) {
+		sliceInsets.push_back(LoopList());
+		LoopList &shells = sliceInsets.back();
 
-        if ((shell == 0 && grueCfg.get_doExternalSpurs()) ||
-            (shell > 0 && grueCfg.get_doInternalSpurs())) {
-            Scalar extra = (grueCfg.get_maxSpurWidth() - layermeasure.getLayerW()
-                            + LOOP_ERROR_FUDGE_FACTOR) / 2 ;
-
-            loopsOffset(shells, sliceOutlines, -(distance + extra), false);
-            loopsOffset(shells, shells, extra, false);
+        if (spurShell[shell]) {
+            loopsOffset(intShells, *miterShell++, extra, false);
         }
         else {
-            loopsOffset(shells, sliceOutlines, -distance);
+            intShells.swap(*squareShell++);
         }
+        intLoopsToLoops(intShells, shells);
 	}
 
 	// calculate the interior of a loop, temporarily hardcode the distance to
 	// half layerW
+	// intShells still holds the innermost shell
 
-	loopsOffset(interiors, sliceInsets.back(), -base_distance);
+	loopsOffset(intShells, intShells, -base_distance);
+	intLoopsToLoops(intShells, interiors);
 }
 
 
@@ -354,55 +653,75 @@ void Regioner::insets(const LayerLoops::const_layer_iterator outlinesBegin,
 		RegionList::iterator regionsEnd,
 		LayerMeasure& layermeasure) {
 
-	LayerLoops::const_layer_iterator outline = outlinesBegin;
-	RegionList::iterator region = regionsBegin;
-	while (outline != outlinesEnd && region != regionsEnd) {
-		tick();
-		const LoopList& currentOutlines = outline->readLoops();
-
-		insetsForSlice(currentOutlines, layermeasure, region->insetLoops, 
-					   region->interiorLoops);
-        for(std::list<LoopList>::iterator depthIter = region->insetLoops.begin(); 
-                depthIter != region->insetLoops.end(); 
-                ++depthIter) {
-            smoothCollection(*depthIter, grueCfg.get_coarseness(), 
-                    grueCfg.get_directionWeight());
-            filterLoops(*depthIter, layermeasure.getLayerW() * 
-                    layermeasure.getLayerW());
-        }
-
-        if(!region->insetLoops.empty()) {
-            loopsOffset(region->interiorLoops, region->insetLoops.back(), 
-                    -grueCfg.get_infillShellSpacingMultiplier() * 
-                    layermeasure.getLayerWidth(region->layerMeasureId));
-        }
-		++outline;
-		++region;
+	//each layer depends only on its own outlines
+	const int layerCount = std::min(outlinesEnd - outlinesBegin, 
+			regionsEnd - regionsBegin);
+#ifdef OMPFF
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int layer = 0; layer < layerCount; ++layer) {
+		insetsForLayer(regionsBegin[layer], layermeasure);
+		tickShared();
 	}
 
     tick();
 }
 
+void Regioner::insetsForLayer(LayerRegions& region, 
+		const LayerMeasure& layermeasure) {
+	//region outlines are the same loops, already in LoopList form
+	const LoopList& currentOutlines = region.outlines;
+
+	LoopList interiors;
+	insetsForSlice(currentOutlines, layermeasure, region.insetLoops, 
+				   interiors);
+	region.interiorLoops.swapLoops(interiors);
+	for(std::list<LoopList>::iterator depthIter = region.insetLoops.begin(); 
+			depthIter != region.insetLoops.end(); 
+			++depthIter) {
+		smoothCollection(*depthIter, grueCfg.get_coarseness(), 
+				grueCfg.get_directionWeight());
+		filterLoops(*depthIter, layermeasure.getLayerW() * 
+				layermeasure.getLayerW());
+	}
+
+	if(!region.insetLoops.empty()) {
+		IntLoopList innermost, interiors;
+		loopsToIntLoops(region.insetLoops.back(), innermost);
+		loopsOffset(interiors, innermost, 
+				-grueCfg.get_infillShellSpacingMultiplier() * 
+				layermeasure.getLayerWidth(region.layerMeasureId));
+		region.interiorLoops.assign(interiors);
+	}
+	//neighbouring layers read the interiors next, fill the cache while 
+	//this layer is still ours alone, the bounds bring the int form along
+	region.interiorLoops.readIntBounds();
+}
+
 void Regioner::flatSurfaces(RegionList::iterator regionsBegin,
 		RegionList::iterator regionsEnd,
 		const Grid& grid) {
 	for (; regionsBegin != regionsEnd; ++regionsBegin) {
 		tick();
-		//GridRanges currentSurface;
-
-//		gridRangesForSlice(regionsBegin->insetLoops, grid,
-//				regionsBegin->flatSurface);
-        regionsBegin->flatSurface.yRays.resize(grid.getXValues().size());
-        regionsBegin->flatSurface.xRays.resize(grid.getYValues().size());
-		//inset supportloops by a fraction of supportmargin
-		LoopList insetSupportLoops;
-		loopsOffset(insetSupportLoops, regionsBegin->supportLoops, 
-				-0.01);
-		gridRangesForSlice(insetSupportLoops, grid,
-				regionsBegin->supportSurface);
+		flatSurfaceForLayer(*regionsBegin, grid);
 	}
 }
 
+void Regioner::flatSurfaceForLayer(LayerRegions& region, const Grid& grid) {
+	//GridRanges currentSurface;
+
+//	gridRangesForSlice(region.insetLoops, grid,
+//			region.flatSurface);
+	region.flatSurface.yRays.resize(grid.getXValues().size());
+	region.flatSurface.xRays.resize(grid.getYValues().size());
+	//inset supportloops by a fraction of supportmargin
+	LoopList insetSupportLoops;
+	loopsOffset(insetSupportLoops, region.supportLoops, 
+			-0.01);
+	gridRangesForSlice(insetSupportLoops, grid,
+			region.supportSurface);
+}
+
 void Regioner::floorForSlice(const GridRanges & currentSurface,
 		const GridRanges & surfaceBelow,
 		const Grid & grid,
@@ -430,29 +749,39 @@ void Regioner::roofing(RegionList::iterator regionsBegin,
 
 	while (above != regionsEnd) {
 		tick();
-//		const GridRanges & currentSurface = current->flatSurface;
-//		const GridRanges & surfaceAbove = above->flatSurface;
-//		GridRanges & roofing = current->roofing;
-        LoopList& roofLoops = current->roofLoops;
-
-//		GridRanges roof;
-//		roofForSlice(currentSurface, surfaceAbove, grid, roof);
-//
-//		grid.trimGridRange(roof, roofLengthCutOff, roofing);
-        LoopList diffResult;
-        if(!above->insetLoops.empty()) {
-            loopsDifference(diffResult, current->interiorLoops, 
-                    above->insetLoops.back());
-        }
-        //compensate for errors in the difference by a fudge factor
-        loopsOffset(roofLoops, diffResult, LOOP_ERROR_FUDGE_FACTOR);
-
+		roofForLayer(*current, &*above);
 		++current;
 		++above;
 	}
 
 	tick();
-	current->roofing = current->flatSurface;
+	roofForLayer(*current, NULL);
+}
+
+void Regioner::roofForLayer(LayerRegions& current, 
+		const LayerRegions* above) {
+	if(above == NULL) {
+		//nothing above the top layer, all of it is roof
+		current.roofing = current.flatSurface;
+		return;
+	}
+//	const GridRanges & currentSurface = current.flatSurface;
+//	const GridRanges & surfaceAbove = above->flatSurface;
+//	GridRanges & roofing = current.roofing;
+
+//	GridRanges roof;
+//	roofForSlice(currentSurface, surfaceAbove, grid, roof);
+//
+//	grid.trimGridRange(roof, roofLengthCutOff, roofing);
+	IntLoopList diffResult;
+	if(!above->insetLoops.empty()) {
+		IntLoopList aboveInsets;
+		loopsToIntLoops(above->insetLoops.back(), aboveInsets);
+		regionDifference(diffResult, current.interiorLoops, aboveInsets);
+	}
+	//compensate for errors in the difference by a fudge factor
+	loopsOffset(diffResult, diffResult, LOOP_ERROR_FUDGE_FACTOR);
+	current.roofLoops.assign(diffResult);
 }
 
 void Regioner::flooring(RegionList::iterator regionsBegin,
@@ -466,218 +795,334 @@ void Regioner::flooring(RegionList::iterator regionsBegin,
 	current++;
 
 	while (current != regionsEnd) {
-        LoopList& floorLoops = current->floorLoops;
 		tick();
-//		const GridRanges & currentSurface = current->flatSurface;
-//		const GridRanges & surfaceBelow = below->flatSurface;
-//		GridRanges & flooring = current->flooring;
-
-//		floorForSlice(currentSurface, surfaceBelow, grid, flooring);
-        LoopList diffResult;
-        if(!below->insetLoops.empty()) {
-            loopsDifference(diffResult, current->interiorLoops, 
-                    below->insetLoops.back());
-        }
-        //compensate for errors in the difference by a fudge factor
-        loopsOffset(floorLoops, diffResult, LOOP_ERROR_FUDGE_FACTOR);
-
+		floorForLayer(*current, &*below);
 		++below;
 		++current;
 	}
 
 	tick();
-//	regionsBegin->flooring = regionsBegin->flatSurface;
-    regionsBegin->floorLoops = regionsBegin->interiorLoops;
+	floorForLayer(*regionsBegin, NULL);
+}
 
+void Regioner::floorForLayer(LayerRegions& current, 
+		const LayerRegions* below) {
+	if(below == NULL) {
+		//nothing below the bottom layer, all of it is floor
+//		current.flooring = current.flatSurface;
+		current.floorLoops = current.interiorLoops;
+		return;
+	}
+//	const GridRanges & currentSurface = current.flatSurface;
+//	const GridRanges & surfaceBelow = below->flatSurface;
+//	GridRanges & flooring = current.flooring;
+
+//	floorForSlice(currentSurface, surfaceBelow, grid, flooring);
+	IntLoopList diffResult;
+	if(!below->insetLoops.empty()) {
+		IntLoopList belowInsets;
+		loopsToIntLoops(below->insetLoops.back(), belowInsets);
+		regionDifference(diffResult, current.interiorLoops, belowInsets);
+	}
+	//compensate for errors in the difference by a fudge factor
+	loopsOffset(diffResult, diffResult, LOOP_ERROR_FUDGE_FACTOR);
+	current.floorLoops.assign(diffResult);
+}
+
+bool Regioner::supportForLayer(IntLoopList& support, 
+		const IntLoopList& supportAbove, 
+		const IntLoopList& aboveMarginsOffset, 
+		const IntLoopList& margins) const {
+	bool simplified = false;
+	if (supportAbove.empty()) {
+		//beginning of new support
+		support = aboveMarginsOffset;
+	} else {
+		//start with a projection of support from the layer above
+		//and add the outlines of layer above
+		loopsUnion(support, supportAbove, aboveMarginsOffset);
+		//projected support only ever gains points, keep it within 
+		//budget so the booleans below don't keep slowing down
+		simplified = loopsSimplifyToBudget(support, 
+				grueCfg.get_supportVertexBudget(), 
+				grueCfg.get_coarseness());
+	}
+	//subtract current outlines from the support loops to keep support
+	//from overlapping the object
+	loopsDifference(support, margins);
+	return simplified;
 }
 
 void Regioner::support(RegionList::iterator regionsBegin,
 		RegionList::iterator regionsEnd, 
 		LayerMeasure& /*layermeasure*/) {
-	std::list<LoopList> marginsList;
+    if(regionsBegin == regionsEnd)
+        return;
+    //support is built top down, each layer's support depending on the one 
+    //above it. The whole chain is kept in clipper's form and converted to 
+    //loops only at the end.
+    const int layerCount = regionsEnd - regionsBegin;
+	std::vector<IntLoopList> marginsList(layerCount);
+	std::vector<IntLoopList> supportList(layerCount);
 	
-	for(RegionList::const_iterator iter = regionsBegin; 
-			iter != regionsEnd; 
-			++iter) {
-		LoopList currentMargins;
-		loopsOffset(currentMargins, iter->outlines, 
+	//each layer's margins are needed as is and grown by two fudge factors
+	std::vector<IntLoopList> fudgedMarginsList(layerCount);
+	std::vector<IntLoopList> wallMarginsList(layerCount);
+	std::vector<Scalar> fudges;
+	fudges.push_back(SUPPORT_FUDGE_FACTOR);
+	fudges.push_back(5 * SUPPORT_FUDGE_FACTOR);
+	
+#ifdef OMPFF
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for(int layer = 0; layer < layerCount; ++layer) {
+		IntLoopList outlines;
+		loopsToIntLoops(regionsBegin[layer].outlines, outlines);
+		loopsOffset(marginsList[layer], outlines, 
 				grueCfg.get_supportMargin());
-		marginsList.push_back(currentMargins);
+		std::vector<IntLoopList> fudged;
+		loopsOffsetMulti(fudged, marginsList[layer], fudges);
+		fudgedMarginsList[layer].swap(fudged[0]);
+		wallMarginsList[layer].swap(fudged[1]);
+		loopsToIntLoops(regionsBegin[layer].supportLoops, supportList[layer]);
 	}
-	RegionList::iterator above = regionsEnd;
-	std::list<LoopList>::const_iterator aboveMargins = marginsList.end();
-	--above; //work from the highest layer down
-	--aboveMargins;
 	
-	RegionList::iterator current = above;
-	std::list<LoopList>::const_iterator currentMargins = aboveMargins;
-	
-	while (above != regionsBegin && 
-			aboveMargins != marginsList.end()) {
-		--current;
-		--currentMargins;
-		
-		LoopList &support = current->supportLoops;
-        
-        //offset aboveMargins by a fudge factor
-        //to compensate for error when we subtracted them from layer above
-        LoopList aboveMarginsOffset;
-        loopsOffset(aboveMarginsOffset, *aboveMargins, SUPPORT_FUDGE_FACTOR);
-        
-		if (above->supportLoops.empty()) {
-			//beginning of new support
-			support = aboveMarginsOffset;
-		} else {
-			//start with a projection of support from the layer above
-			support = above->supportLoops;
-			//add the outlines of layer above
-			loopsUnion(support, aboveMarginsOffset);
+	if (grueCfg.get_regionBackend() == GrueConfig::REGION_RASTER) {
+		//walls are already erased, only conversion is left
+		rasterSupport(supportList, marginsList, fudgedMarginsList, 
+				wallMarginsList);
+#ifdef OMPFF
+#pragma omp parallel for schedule(dynamic)
+#endif
+		for(int layer = 0; layer < layerCount; ++layer) {
+			intLoopsToLoops(supportList[layer], 
+					regionsBegin[layer].supportLoops);
+			tickShared();
 		}
-        tick();
-		//subtract current outlines from the support loops to keep support
-		//from overlapping the object
-
-		//use margins computed up front
-		loopsDifference(support, *currentMargins);
-		--above;
-		--aboveMargins;
-		//tick();
+		return;
 	}
-	current = regionsBegin;
-	currentMargins = marginsList.begin();
-	above = current;
-	aboveMargins = currentMargins;
-	++above;
-	++aboveMargins;
+	
+	//work from the highest layer down, each layer needs the support of 
+	//the one above it
+	size_t simplifiedCount = 0;
+	for(int above = layerCount - 1; above > 0; --above) {
+		const int current = above - 1;
+		if (supportForLayer(supportList[current], supportList[above], 
+				fudgedMarginsList[above], marginsList[current]))
+			++simplifiedCount;
+		tick();
+	}
+	Log::fine() << "Support simplified on " << simplifiedCount 
+			<< " layers" << endl;
 	
     //this part is the hack that erases support from vertical walls
     //after the fact
-	while(current != regionsEnd && 
-			currentMargins != marginsList.end()) {
-        LoopList currentMarginsOffset;
-        loopsOffset(currentMarginsOffset, *currentMargins, 5 * SUPPORT_FUDGE_FACTOR);
-        loopsDifference(current->supportLoops, currentMarginsOffset);
-		++current;
-		++currentMargins;
-		tick();
+#ifdef OMPFF
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for(int layer = 0; layer < layerCount; ++layer) {
+        loopsDifference(supportList[layer], wallMarginsList[layer]);
+        intLoopsToLoops(supportList[layer], regionsBegin[layer].supportLoops);
+		tickShared();
 	}
 	
 }
 
+void Regioner::rasterSupport(std::vector<IntLoopList>& supportList, 
+		const std::vector<IntLoopList>& marginsList, 
+		const std::vector<IntLoopList>& fudgedMarginsList, 
+		const std::vector<IntLoopList>& wallMarginsList) {
+	const size_t layerCount = supportList.size();
+	//support only ever grows from the top layer's support and the margins 
+	//of the layers above, so a frame around those holds all of it
+	ClipperLib::IntRect frame;
+	bool found = loopsBounds(supportList.back(), frame);
+	for(size_t layer = 1; layer < layerCount; ++layer) {
+		ClipperLib::IntRect bounds;
+		if (!loopsBounds(fudgedMarginsList[layer], bounds))
+			continue;
+		if (!found) {
+			frame = bounds;
+			found = true;
+			continue;
+		}
+		frame.left = std::min(frame.left, bounds.left);
+		frame.top = std::min(frame.top, bounds.top);
+		frame.right = std::max(frame.right, bounds.right);
+		frame.bottom = std::max(frame.bottom, bounds.bottom);
+	}
+	if (!found) {
+		for(size_t layer = 0; layer < layerCount; ++layer)
+			supportList[layer].clear();
+		return;
+	}
+	
+	const ClipperLib::long64 cell = scalarToIntLength(rasterCellSize);
+	LayerBitmap projected(frame, cell);
+	LayerBitmap scratch(frame, cell);
+	projected.draw(supportList.back());
+	for(size_t current = layerCount; current-- > 0; ) {
+		const size_t above = current + 1;
+		if (above < layerCount) {
+			//project support from the layer above, add the outlines of 
+			//the layer above, and keep it from overlapping this layer
+			scratch.clear();
+			scratch.draw(fudgedMarginsList[above]);
+			projected |= scratch;
+			scratch.clear();
+			scratch.draw(marginsList[current]);
+			projected.subtract(scratch);
+			tick();
+		}
+		//walls are only erased from what is printed on this layer
+		LayerBitmap printed(projected);
+		scratch.clear();
+		scratch.draw(wallMarginsList[current]);
+		printed.subtract(scratch);
+		printed.contours(supportList[current]);
+		//cell outlines step along every slanted edge, straighten them. 
+		//Rings are straightened one by one and may then cross, so the 
+		//nonzero union makes them proper loops again
+		loopsSimplify(supportList[current], rasterCellSize);
+		loopsNonZeroUnion(supportList[current]);
+	}
+}
+
+void Regioner::regionDifference(IntLoopList& dest, 
+		const CachedLoopList& subject, const IntLoopList& apply) const {
+	if (grueCfg.get_regionBackend() == GrueConfig::REGION_RASTER) {
+		bitmapDifference(dest, subject.readIntLoops(), apply, 
+				scalarToIntLength(rasterCellSize));
+		//cell outlines step along every slanted edge, straighten them 
+		//and untangle any rings that cross as a result
+		loopsSimplify(dest, rasterCellSize);
+		loopsNonZeroUnion(dest);
+	} else
+		loopsDifference(dest, subject, apply);
+}
+
 void Regioner::infills(RegionList::iterator regionsBegin,
 		RegionList::iterator regionsEnd,
 		const Grid &grid) {
-    size_t sequenceNumber = 0;
+	InfillWindows windows(regionsBegin, regionsEnd);
 	for (RegionList::iterator current = regionsBegin;
-			current != regionsEnd; ++current, ++sequenceNumber) {
-
-		const GridRanges &surface = current->flatSurface;
+			current != regionsEnd; ++current) {
 		tick();
+		infillsForLayer(windows, current, grid);
+	}
 
-		// Solids
-		//GridRanges combinedSolid;
-        LoopList combinedLoops;
-
-//		combinedSolid.xRays.resize(surface.xRays.size());
-//		combinedSolid.yRays.resize(surface.yRays.size());
-
-		//TODO: no reason to get bounds separately from the combination
+}
 
-		//find the bounds we will be combinging regions across
-		RegionList::iterator firstFloor = current;
-        RegionList::iterator floorEnd = current;
-		for (unsigned int i = 1; i < grueCfg.get_floorLayerCount() &&
-				firstFloor != regionsBegin; ++i)
-			--firstFloor;
+Regioner::InfillWindows::InfillWindows(RegionList::iterator begin, 
+		RegionList::iterator end, LayerReuse* layerReuse)
+		: regionsBegin(begin), regionsEnd(end), roofNext(begin), 
+		reuse(layerReuse) {}
 
-		RegionList::iterator lastRoof = current;
-        RegionList::iterator roofEnd = current;
-		for (unsigned int i = 1; i < grueCfg.get_roofLayerCount() &&
-				lastRoof != regionsEnd - 1; ++i)
-			++lastRoof;
-        
-        if(grueCfg.get_floorLayerCount() > 0)
-            ++floorEnd;
-        if(grueCfg.get_roofLayerCount() > 0)
-            --roofEnd;
-		//combine floors
-		for (RegionList::iterator floor = firstFloor;
-				floor != floorEnd; ++floor) {
-//			GridRanges multiFloor;
-
-//			grid.gridRangeUnion(combinedSolid, floor->flooring, multiFloor);
-//			combinedSolid = multiFloor;
-            loopsUnion(combinedLoops, floor->floorLoops);
-		}
+void Regioner::infillsForLayer(InfillWindows& windows, 
+		RegionList::iterator current,
+		const Grid& grid) {
+	const size_t sequenceNumber = current - windows.regionsBegin;
+	//floors of this and the layers below, roofs of this and the layers above
+	size_t floorCount = grueCfg.get_floorLayerCount();
+	size_t roofCount = grueCfg.get_roofLayerCount();
+	SlidingLoopsUnion& floorWindow = windows.floors;
+	SlidingLoopsUnion& roofWindow = windows.roofs;
+	RegionList::iterator& roofNext = windows.roofNext;
+	const RegionList::iterator regionsEnd = windows.regionsEnd;
+	const GridRanges &surface = current->flatSurface;
+
+	// Solids
+	//GridRanges combinedSolid;
+    IntLoopList combinedInt;
+
+	//slide the floor window up to end at this layer and the roof window 
+	//up to start at it
+	if (floorCount > 0) {
+		floorWindow.push(current->floorLoops.readIntLoops());
+		if (floorWindow.size() > floorCount)
+			floorWindow.pop();
+	}
+	for (; roofNext != regionsEnd && 
+			size_t(roofNext - current) < roofCount; ++roofNext)
+		roofWindow.push(roofNext->roofLoops.readIntLoops());
+
+    if(grueCfg.get_doSupport() || grueCfg.get_doRaft()) {
+        size_t supportSkipCount = 0;
+        if(grueCfg.get_doRaft() && sequenceNumber < grueCfg.get_raftLayers()) {
+            supportSkipCount = (int) (1 / grueCfg.get_raftDensity()) - 1;
+            grid.subSample(current->supportSurface, supportSkipCount,
+                    current->support);
+        } else if(grueCfg.get_doSupport()) {
+            supportSkipCount = (int) (1 / grueCfg.get_supportDensity()) - 1;
+            grid.subSample(current->supportSurface, supportSkipCount,
+                    current->support);
+        }
+    }
 
-		//combine roofs
-		for (RegionList::iterator roof = lastRoof;
-				roof != roofEnd; --roof) {
-//			GridRanges multiRoof;
+	//the infill comes from this layer's interior and the floors and roofs 
+	//in the windows, which depend on the shapes of the layers they span
+	if (windows.reuse && windows.reuse->findInfill(sequenceNumber, 
+			floorCount, roofCount, current->infill)) {
+		if (roofCount > 0)
+			roofWindow.pop();
+		return;
+	}
 
-//			grid.gridRangeUnion(combinedSolid, roof->roofing, multiRoof);
-//			combinedSolid = multiRoof;
-            loopsUnion(combinedLoops, roof->roofLoops);
-		}
+	//combine floors and roofs
+	IntLoopList floorInt, roofInt;
+	floorWindow.result(floorInt);
+	roofWindow.result(roofInt);
+	loopsUnion(combinedInt, floorInt, roofInt);
+	if (roofCount > 0)
+		roofWindow.pop();
 
-		// solid now contains the combination of combinedSolid regions from
-		// multiple slices. We need to extract the perimeter from it
+	// solid now contains the combination of combinedSolid regions from
+	// multiple slices. We need to extract the perimeter from it
 
 //		grid.gridRangeIntersection(surface, combinedSolid, current->solid);
-        loopsIntersection(combinedLoops, current->interiorLoops);
-        LoopList sparseLoops;
-        loopsDifference(sparseLoops, current->interiorLoops, combinedLoops);
-        
-
-		// TODO: move me to the slicer
-		GridRanges sparseInfill, sparsePreInfill, solidInfill;
-        
-        gridRangesForSlice(combinedLoops, grid, solidInfill);
-        gridRangesForSlice(sparseLoops, grid, sparsePreInfill);
-        
-		size_t infillSkipCount = (int) (1 / grueCfg.get_infillDensity()) - 1;
-
-		grid.subSample(sparsePreInfill, infillSkipCount, sparseInfill);
-        
-        if(grueCfg.get_doSupport() || grueCfg.get_doRaft()) {
-            size_t supportSkipCount = 0;
-            if(grueCfg.get_doRaft() && sequenceNumber < grueCfg.get_raftLayers()) {
-                supportSkipCount = (int) (1 / grueCfg.get_raftDensity()) - 1;
-                grid.subSample(current->supportSurface, supportSkipCount,
-                        current->support);
-            } else if(grueCfg.get_doSupport()) {
-                supportSkipCount = (int) (1 / grueCfg.get_supportDensity()) - 1;
-                grid.subSample(current->supportSurface, supportSkipCount,
-                        current->support);
-            }
-        }
-
-		//grid.gridRangeUnion(current->solid, sparseInfill, current->infill);
-        current->infill.xRays.resize(surface.xRays.size());
-        current->infill.yRays.resize(surface.yRays.size());
-        
-        for(size_t x = 0; x < surface.xRays.size(); ++x) {
-            current->infill.xRays[x].insert(
-                    current->infill.xRays[x].end(), 
-                    sparseInfill.xRays[x].begin(), 
-                    sparseInfill.xRays[x].end());
-            current->infill.xRays[x].insert(
-                    current->infill.xRays[x].end(), 
-                    solidInfill.xRays[x].begin(), 
-                    solidInfill.xRays[x].end());
-        }
-        for(size_t y = 0; y < surface.yRays.size(); ++y) {
-            current->infill.yRays[y].insert(
-                    current->infill.yRays[y].end(), 
-                    sparseInfill.yRays[y].begin(), 
-                    sparseInfill.yRays[y].end());
-            current->infill.yRays[y].insert(
-                    current->infill.yRays[y].end(), 
-                    solidInfill.yRays[y].begin(), 
-                    solidInfill.yRays[y].end());
-        }
-	}
+    IntLoopList sparseInt;
+    loopsIntersection(combinedInt, current->interiorLoops);
+    loopsDifference(sparseInt, current->interiorLoops, combinedInt);
+    LoopList combinedLoops, sparseLoops;
+    intLoopsToLoops(combinedInt, combinedLoops);
+    intLoopsToLoops(sparseInt, sparseLoops);
+    
 
+	// TODO: move me to the slicer
+	GridRanges sparsePreInfill, solidInfill;
+    
+    gridRangesForSlice(combinedLoops, grid, solidInfill);
+    gridRangesForSlice(sparseLoops, grid, sparsePreInfill);
+    
+	size_t infillSkipCount = (int) (1 / grueCfg.get_infillDensity()) - 1;
+
+	//only read once below, so the lines are left where they are
+	GridRangesView sparseInfill = grid.subSample(sparsePreInfill, 
+			infillSkipCount);
+
+	//grid.gridRangeUnion(current->solid, sparseInfill, current->infill);
+    //sparse then solid ranges on each line, as the rows are built in order
+    ScalarRangeTable& infillX = current->infill.xRays;
+    ScalarRangeTable& infillY = current->infill.yRays;
+    infillX.clear();
+    infillX.reserve(surface.xRays.size(), sparseInfill.xRays.rangeCount() + 
+            solidInfill.xRays.rangeCount());
+    for(size_t x = 0; x < surface.xRays.size(); ++x) {
+        infillX.addRow();
+        infillX.append(sparseInfill.xRays[x]);
+        infillX.append(solidInfill.xRays[x]);
+    }
+    infillY.clear();
+    infillY.reserve(surface.yRays.size(), sparseInfill.yRays.rangeCount() + 
+            solidInfill.yRays.rangeCount());
+    for(size_t y = 0; y < surface.yRays.size(); ++y) {
+        infillY.addRow();
+        infillY.append(sparseInfill.yRays[y]);
+        infillY.append(solidInfill.yRays[y]);
+    }
+    if (windows.reuse)
+        windows.reuse->keepInfill(sequenceNumber, floorCount, roofCount, 
+                current->infill);
 }
 
 void Regioner::gridRangesForSlice(const std::list<LoopList>& allInsetsForSlice,
@@ -702,7 +1147,7 @@ void Regioner::gridRangesForSlice(const LoopList& innerMostLoops,
 */
 
 #include "intersection_index.h"
-#include "basic_boxlist.h"
+#include "basic_packed_rtree.h"
 
 #include <algorithm>
 #include <math.h>
@@ -712,8 +1157,6 @@ void Regioner::gridRangesForSlice(const LoopList& innerMostLoops,
  * convenience types
  *******/
 
-typedef pair<LineSegment2, LineSegment2> SegmentPair;
-
 typedef Eigen::ParametrizedLine<Scalar, 2> ELine;
 typedef Eigen::Vector2d EVector;
 typedef Eigen::Hyperplane<Scalar, 2> EHyperplane;
@@ -804,20 +1247,17 @@ bool SegLess(const LineSegment2 &first, const LineSegment2 &second) {
 /**
    @brief Less comparator for SegmentPairs.  See VectorLess for guidelines
  */
-struct SegPairLess {
-	bool operator()(const SegmentPair first, const SegmentPair second) {
-		if (SegLess(first.first, second.first))
-			return true;
-		else if (SegLess(second.first, first.first))
-			return false;
-		else if (SegLess(first.second, second.second))
-			return true;
-		else 
-			return false;
-	}
-};
-
-typedef set<SegmentPair, SegPairLess> SegmentPairSet;
+bool mgl::SegPairLess::operator()(const SegmentPair& first, 
+		const SegmentPair& second) const {
+	if (SegLess(first.first, second.first))
+		return true;
+	else if (SegLess(second.first, first.first))
+		return false;
+	else if (SegLess(first.second, second.second))
+		return true;
+	else 
+		return false;
+}
 
 /**
    @brief Make sure SegmentPairs that are similar are actually the same.
@@ -927,6 +1367,23 @@ void findIntersecting(SegmentIndex &index, const LineSegment2 &subject,
 	}
 }
 
+/**
+   @brief Keep the segments in @a candidates that intersect @a subject, in
+   order.  Gives the same as searching the index the candidates came from
+   so long as they include every segment near @a subject
+*/
+void findIntersecting(const SegmentList &candidates,
+                      const LineSegment2 &subject,
+                      SegmentList &intersecting) {
+    LineSegmentFilter filter(subject);
+    for (SegmentList::const_iterator possible = candidates.begin();
+         possible != candidates.end(); ++possible) {
+        if (filter.filter(to_bbox<LineSegment2>::bound(*possible)) &&
+            possible->intersects(subject))
+            intersecting.push_back(*possible);
+    }
+}
+
 /**
    @brief Convenience function for finding intersection poitns in a spacial index
  */
@@ -986,6 +1443,111 @@ void expandSeg(LineSegment2 &seg, Scalar len) {
     seg.b -= extra;
 }
 
+/*******
+ * skipping layers without spurs
+ *******/
+
+//well above the rounding of points to clipper's integer coordinates
+static const Scalar POINT_ROUNDING = 0.0002;
+
+/// an edge of a loop, by the angle it points at
+struct EdgeDirection {
+	Scalar angle;
+	Scalar length;
+	bool operator<(const EdgeDirection& other) const {
+		return angle < other.angle;
+	}
+};
+
+/**
+ @brief directions of the edges of all @a loops, sorted by angle
+ @return false if an edge has no length or a corner turns too sharply
+ for a mitered offset to keep it
+ */
+static bool sortedEdgeDirections(const LoopList& loops,
+		std::vector<EdgeDirection>& directions) {
+	//clipper squares off miters longer than twice the offset, that is
+	//corners turning by more than 120 degrees. Stay clear of the limit.
+	const Scalar minTurnCosine = -0.4;
+	directions.clear();
+	for (LoopList::const_iterator loop = loops.begin();
+			loop != loops.end(); ++loop) {
+		Vector2 first, previous;
+		bool started = false;
+		for (Loop::const_finite_cw_iterator pn = loop->clockwiseFinite();
+				pn != loop->clockwiseEnd(); ++pn) {
+			LineSegment2 seg = loop->segmentAfterPoint(pn);
+			Vector2 along = seg.b - seg.a;
+			EdgeDirection edge;
+			edge.length = along.magnitude();
+			if (edge.length == 0)
+				return false;
+			along *= 1 / edge.length;
+			edge.angle = atan2(along.y, along.x);
+			directions.push_back(edge);
+			if (!started) {
+				first = along;
+				started = true;
+			} else if (previous.dotProduct(along) < minTurnCosine) {
+				return false;
+			}
+			previous = along;
+		}
+		if (started && previous.dotProduct(first) < minTurnCosine)
+			return false;
+	}
+	std::sort(directions.begin(), directions.end());
+	return true;
+}
+
+/// whether every edge of one list has a parallel edge in the other
+static bool sameEdgeDirections(const std::vector<EdgeDirection>& a,
+		const std::vector<EdgeDirection>& b) {
+	if (a.size() != b.size())
+		return false;
+	for (size_t edge = 0; edge < a.size(); ++edge) {
+		const Scalar tolerance = POINT_ROUNDING /
+				std::min(a[edge].length, b[edge].length);
+		if (fabs(a[edge].angle - b[edge].angle) > tolerance)
+			return false;
+	}
+	return true;
+}
+
+/*
+ A shell taking part in spurs is the outline, or the shell outside it,
+ offset inward with mitered corners. Where no edge vanishes and no part
+ splits off or disappears, every edge of the outer loops comes through
+ as a parallel edge of the shell and the sharp corner check keeps
+ clipper from squaring any corner off. Offsetting such a shell back out
+ covers all of the outer loops, so spurLoopsForSlice would find nothing.
+ An edge lost to a narrow part drops a direction from the shell, so a
+ shell with the same loop count and the same edge directions as the
+ loops outside it leaves no room for spurs.
+ */
+bool Regioner::layerMayHaveSpurs(const LayerRegions& region) const {
+	std::vector<EdgeDirection> outer, inner;
+	if (!sortedEdgeDirections(region.outlines, outer))
+		return true;
+	const LoopList* outerLoops = &region.outlines;
+	bool spurShell = grueCfg.get_doExternalSpurs();
+	for (std::list<LoopList>::const_iterator shell =
+			region.insetLoops.begin();
+			shell != region.insetLoops.end(); ++shell) {
+		if (!sortedEdgeDirections(*shell, inner))
+			return true;
+		if (spurShell && (shell->size() != outerLoops->size() ||
+				!sameEdgeDirections(outer, inner)))
+			return true;
+		if (!grueCfg.get_doInternalSpurs())
+			break;
+		outer.swap(inner);
+		outerLoops = &*shell;
+		spurShell = true;
+	}
+	return false;
+}
+
 /*******
  * main code for spurs
  *******/
@@ -1040,7 +1602,8 @@ void Regioner::spurLoopsForSlice(const LoopList& sliceOutlines,
 
 void Regioner::fillSpursForSlice(const std::list<LoopList>& spurLoopsPerShell,
 								 const LayerMeasure &layermeasure,
-								 std::list<OpenPathList> &spursPerShell) {
+								 std::list<OpenPathList> &spursPerShell, 
+								 LayerArena* arena) {
 	for (std::list<LoopList>::const_iterator spurLoops =
 			 spurLoopsPerShell.begin();
 		 spurLoops != spurLoopsPerShell.end(); ++spurLoops) {
@@ -1049,7 +1612,7 @@ void Regioner::fillSpursForSlice(const std::list<LoopList>& spurLoopsPerShell,
 		OpenPathList &spurs = spursPerShell.back();
 
         //just call fillSpurLoops on every grouping of spurs
-		fillSpurLoops(*spurLoops, layermeasure, spurs);
+		fillSpurLoops(*spurLoops, layermeasure, spurs, arena);
 	}
 }
 
@@ -1257,17 +1820,24 @@ bool completeTrapezoid(const Scalar toplen, const Scalar bottomlen,
    @param index Pre-build spacial index of segs
    @param walls Output, resulting wall pairs
  */
-void findWallPairs(const Scalar span, const SegmentList segs,
+void mgl::findWallPairs(const Scalar span, const SegmentList segs,
 				   SegmentIndex &index, SegmentPairSet &walls) {
 
+	SegmentList neighbours;
 	for (SegmentList::const_iterator curSeg = segs.begin();
 		 curSeg != segs.end(); ++curSeg) {
 
+        //both normals stay within span of the segment, a little more 
+        //leaves room for rounding
+        neighbours.clear();
+        index.searchNear(neighbours, to_bbox<LineSegment2>::bound(*curSeg),
+                         span * 1.1);
+
         //find segments that intersect with a normal drawn from endpoint a
 		LineSegment2 normal = getSegmentNormal(*curSeg, curSeg->a, span);
 		SegmentList intersecting;
 
-		findIntersecting(index, normal, intersecting);
+		findIntersecting(neighbours, normal, intersecting);
         for(SegmentList::const_iterator iter = intersecting.begin(); 
                 iter != intersecting.end();
                 ++iter) {
@@ -1282,7 +1852,7 @@ void findWallPairs(const Scalar span, const SegmentList segs,
 
         intersecting.clear();
         
-		findIntersecting(index, normal, intersecting);
+		findIntersecting(neighbours, normal, intersecting);
 		for(SegmentList::const_iterator iter = intersecting.begin(); 
                 iter != intersecting.end();
                 ++iter) {
@@ -1596,7 +2166,8 @@ void Regioner::chainSpurSegments(SegmentIndex &outline, const Scalar margin,
 
 void Regioner::fillSpurLoops(const LoopList &spurLoops,
 							 const LayerMeasure &layermeasure,
-							 OpenPathList &spurs) {
+							 OpenPathList &spurs, 
+							 LayerArena* arena) {
 
     Scalar minSpurWidth = grueCfg.get_minSpurWidth();
     Scalar maxSpurWidth = grueCfg.get_maxSpurWidth();
@@ -1621,7 +2192,8 @@ void Regioner::fillSpurLoops(const LoopList &spurLoops,
 	}
 
 	//find wall pairs
-	SegmentPairSet allWalls;
+	layer_allocator<SegmentPair> scratchAlloc(arena);
+	SegmentPairSet allWalls(SegPairLess(), scratchAlloc);
 	findWallPairs(maxSpurWidth + LOOP_ERROR_FUDGE_FACTOR,
                   segs, index, allWalls);
 
@@ -1660,18 +2232,47 @@ void Regioner::fillSpurLoops(const LoopList &spurLoops,
 void Regioner::spurs(RegionList::iterator regionsBegin,
                      RegionList::iterator regionsEnd,
                      LayerMeasure &layermeasure) {
-    for (RegionList::iterator region = regionsBegin;
-         region != regionsEnd; ++region) {
-        tick();
-
-        //get spur loops, then fill them
-        spurLoopsForSlice(region->outlines, region->insetLoops,
-                           layermeasure, region->spurLoops);
-        fillSpursForSlice(region->spurLoops, layermeasure, region->spurs);
+    //layers are independent, each worker reuses its own scratch storage
+    const int layerCount = regionsEnd - regionsBegin;
+#ifdef OMPFF
+#pragma omp parallel
+#endif
+    {
+        LayerArena spurArena;
+#ifdef OMPFF
+#pragma omp for schedule(dynamic)
+#endif
+        for (int layer = 0; layer < layerCount; ++layer) {
+            spurArena.release();
+            spursForLayer(regionsBegin[layer], layermeasure, &spurArena);
+            tickShared();
+        }
     }
 
     tick();
 }
 
+void Regioner::spursForLayer(LayerRegions& region, 
+                             const LayerMeasure &layermeasure, 
+                             LayerArena* arena) {
+    if (!layerMayHaveSpurs(region)) {
+        //the same empty list per shell the full pass leaves
+        size_t shellCount = grueCfg.get_doExternalSpurs() ? 1 : 0;
+        if (grueCfg.get_doInternalSpurs() && !region.insetLoops.empty())
+            shellCount += region.insetLoops.size() - 1;
+        region.spurLoops.resize(region.spurLoops.size() + shellCount);
+        region.spurs.resize(region.spurs.size() + shellCount);
+#ifdef OMPFF
+#pragma omp atomic
+#endif
+        ++spurlessLayers;
+        return;
+    }
+    //get spur loops, then fill them
+    spurLoopsForSlice(region.outlines, region.insetLoops,
+                       layermeasure, region.spurLoops);
+    fillSpursForSlice(region.spurLoops, layermeasure, region.spurs, arena);
+}
+
 
 
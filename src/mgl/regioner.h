@@ -18,7 +18,9 @@
 #include "slicer.h"
 #include "slicer_loops.h"
 #include "loop_path.h"
-#include "basic_boxlist.h"
+#include "loop_utils.h"
+#include "basic_packed_rtree.h"
+#include "layer_arena.h"
 
 namespace mgl {
 
@@ -72,9 +74,11 @@ public:
 	std::list<LoopList> insetLoops;
     std::list<LoopList> spurLoops;
 	LoopList supportLoops;
-	LoopList interiorLoops;
-    LoopList floorLoops;
-    LoopList roofLoops;
+	//these take part in boolean ops for several layers, so they keep 
+	//their fixed point form around
+	CachedLoopList interiorLoops;
+    CachedLoopList floorLoops;
+    CachedLoopList roofLoops;
 
     std::list<OpenPathList> spurs;
 
@@ -91,14 +95,49 @@ public:
 	GridRanges sparse;
 
 	layer_measure_index_t layerMeasureId;
+
+	/// drop every loop, path and range of the layer, freeing their memory
+	void clear();
 };
 
 typedef std::vector<LayerRegions> RegionList;
 
+/**
+ @brief Takes the regions of each layer as soon as the Regioner is done 
+ with them
+ 
+ Layers come bottom up, one at a time. Under OMPFF they may come from 
+ different threads, though never two at once.
+ */
+class RegionSink {
+public:
+	virtual ~RegionSink() {}
+	/// called once before any layer, with the number of layers to come
+	virtual void startRegions(size_t layerCount) = 0;
+	/// regions of the next layer, valid only until this returns
+	virtual void takeRegions(const LayerRegions& regions) = 0;
+};
+
 typedef std::vector<libthing::LineSegment2> SegmentList;
 typedef std::vector<PointList> PointTable;
 
-typedef basic_boxlist<libthing::LineSegment2> SegmentIndex;
+typedef basic_packed_rtree<libthing::LineSegment2> SegmentIndex;
+
+/// two outline segments close enough across a wall to span with a spur
+typedef std::pair<libthing::LineSegment2, libthing::LineSegment2> SegmentPair;
+
+/// orders SegmentPairs for uniqueness rather than in any real order
+struct SegPairLess {
+	bool operator()(const SegmentPair& first, 
+			const SegmentPair& second) const;
+};
+
+typedef std::set<SegmentPair, SegPairLess, layer_allocator<SegmentPair> > 
+		SegmentPairSet;
+
+/// pairs of outline segments within @a span of each other, see regioner.cc
+void findWallPairs(const Scalar span, const SegmentList segs,
+				   SegmentIndex &index, SegmentPairSet &walls);
 struct SpurPieceFlags {
     SpurPieceFlags() : first(true), last(true), all(true) {};
 
@@ -110,24 +149,34 @@ struct SpurPieceFlags {
 typedef std::vector<SpurPieceFlags> FlagsList;
 
 
+class LayerReuse;
+
 //// Class to calculate regions of a model
 ///
 
 class Regioner : public Progressive {
 	Scalar roofLengthCutOff;
+	Scalar rasterCellSize;
+	size_t spurlessLayers; //< layers spursForLayer found no room for spurs on
 public:
     const GrueConfig& grueCfg;
 
     Regioner(const GrueConfig& grueConf, 
             ProgressBar* progress = NULL);
 
-	void generateSkeleton(const LayerLoops& layerloops, 
+	/// loops in @a layerloops are moved into @a regionlist, leaving the 
+	/// layers of @a layerloops in place but empty. With a @a sink, each 
+	/// layer is handed to it once finished and cleared once no other 
+	/// layer reads it, so only a window of layers is held at a time and 
+	/// @a regionlist ends up with every layer empty.
+	void generateSkeleton(LayerLoops& layerloops, 
 						  LayerMeasure &layerMeasure, 
 						  RegionList &regionlist, 
 						  Limits& limits, //updated to reflect outsets
-						  Grid& grid);	//initialized here
+						  Grid& grid,	//initialized here
+						  RegionSink* sink = NULL);
 
-	size_t initRegionList(const LayerLoops& layerloops,
+	size_t initRegionList(LayerLoops& layerloops,
 						  RegionList &regionlist, 
 						  LayerMeasure& layermeasure,
 						  RegionList::iterator& firstmodellayer);
@@ -146,10 +195,14 @@ public:
 				RegionList::iterator regionsBegin,
 				RegionList::iterator regionsEnd,
 				LayerMeasure& layermeasure);
+	/// insets and interiors of one layer, reading only its outlines
+	void insetsForLayer(LayerRegions& region, 
+						const LayerMeasure& layermeasure);
 
 	void flatSurfaces(RegionList::iterator regionsBegin,
 					  RegionList::iterator regionsEnd,
 					  const Grid& grid);
+	void flatSurfaceForLayer(LayerRegions& region, const Grid& grid);
 
 	void floorForSlice(const GridRanges & currentSurface, 
 					   const GridRanges & surfaceBelow, 
@@ -159,6 +212,12 @@ public:
 	void roofing(RegionList::iterator regionsBegin,
 				 RegionList::iterator regionsEnd,
 				 const Grid& grid);
+	/**
+	 @brief roof loops of @a current, the parts of it not covered by 
+	 @a above
+	 @param above layer above, NULL if @a current is the top layer
+	 */
+	void roofForLayer(LayerRegions& current, const LayerRegions* above);
 
 	void roofForSlice(const GridRanges & currentSurface, 
 			const GridRanges & surfaceAbove, 
@@ -168,16 +227,42 @@ public:
 	void flooring(RegionList::iterator regionsBegin,
 				  RegionList::iterator regionsEnd,
 				  const Grid &grid);
+	/**
+	 @brief floor loops of @a current, the parts of it not covered by 
+	 @a below
+	 @param below layer below, NULL if @a current is the bottom layer
+	 */
+	void floorForLayer(LayerRegions& current, const LayerRegions* below);
 
 	void support(RegionList::iterator regionsBegin,
 				 RegionList::iterator regionsEnd ,
 				 LayerMeasure& layermeasure);
+	/**
+	 @brief support of one layer from the support of the layer above
+	 @param aboveMarginsOffset margins of the layer above, slightly grown
+	 @param margins margins of this layer
+	 @return whether the projected support had to be simplified
+	 */
+	bool supportForLayer(IntLoopList& support, 
+						 const IntLoopList& supportAbove, 
+						 const IntLoopList& aboveMarginsOffset, 
+						 const IntLoopList& margins) const;
 
 
 	void infills(RegionList::iterator regionsBegin,
 				 RegionList::iterator regionsEnd,
 				 const Grid &grid);
 
+	/// what infills carries from one layer to the next, see regioner.cc
+	struct InfillWindows;
+	/**
+	 @brief infill of one layer, layers must be given in order from the 
+	 first one @a windows was made with
+	 */
+	void infillsForLayer(InfillWindows& windows, 
+						 RegionList::iterator current,
+						 const Grid &grid);
+
 
 	void gridRangesForSlice(const std::list<LoopList>& allInsetsForSlice, 
 							const Grid& grid, 
@@ -200,6 +285,22 @@ public:
                RegionList::iterator regionsEnd,
                LayerMeasure &layermeasure);
 
+    /**
+       @brief Spur loops and spurs of one layer
+       @param arena scratch storage released by the caller between layers, 
+       NULL to use the heap
+     */
+    void spursForLayer(LayerRegions& region, 
+                       const LayerMeasure &layermeasure, 
+                       LayerArena* arena = NULL);
+
+    /**
+       @brief false when the spur shells of @a region are the loops outside
+       them offset without losing an edge, leaving nothing for 
+       spurLoopsForSlice to find. Cheap, and errs towards true.
+    */
+    bool layerMayHaveSpurs(const LayerRegions& region) const;
+
     /**
        @brief Generate loops for spur regions, regions inside shells left out
        by inner shells
@@ -218,20 +319,25 @@ public:
        @brief Take a set of spur loops, grouped by their outline and fill them
        with spurs.  Expects them to be manifold, with correct normals, and not
        be larger than a spur can traverse
+       @param arena scratch storage released by the caller between layers, 
+       NULL to use the heap
      */
 	void fillSpursForSlice(const std::list<LoopList>& spurLoopsPerShell,
 						   const LayerMeasure &layermeasure,
-						   std::list<OpenPathList> &spursPerShell);
+						   std::list<OpenPathList> &spursPerShell, 
+						   LayerArena* arena = NULL);
 
     /**
        @brief Fill a list of spur loops attached to the same outline
        @param spurLoops outlines for all the spur regions
        @param layermeasure LayerMeasure object for this print
        @param spurs Output, the spur paths for these loops
+       @param arena scratch storage for wall pairs, NULL to use the heap
     */
 	void fillSpurLoops(const LoopList &spurLoops,
 					   const LayerMeasure &layermeasure,
-					   OpenPathList &spurs);
+					   OpenPathList &spurs, 
+					   LayerArena* arena = NULL);
 
     /**
        @brief Connect spur pieces to each other by finding their intersection
@@ -264,6 +370,21 @@ public:
 
 
 private:
+	class ProgressTicker;
+
+	/**
+	 @brief the support chain worked out on bitmaps, for the raster 
+	 region backend
+	 @param supportList the top layer's support on entry, each layer's 
+	 support with walls erased on return
+	 */
+	void rasterSupport(std::vector<IntLoopList>& supportList, 
+					   const std::vector<IntLoopList>& marginsList, 
+					   const std::vector<IntLoopList>& fudgedMarginsList, 
+					   const std::vector<IntLoopList>& wallMarginsList);
+	/// @a subject minus @a apply, by the configured region backend
+	void regionDifference(IntLoopList& dest, const CachedLoopList& subject, 
+						  const IntLoopList& apply) const;
 };
 
 }
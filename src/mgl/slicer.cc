@@ -21,10 +21,14 @@ void Slicer::generateLoops(const Segmenter& seg, LayerLoops& layerloops) {
 	
 	layerloops.layerMeasure = seg.readLayerMeasure();
 	layerloops.layerMeasure.getLayerAttributes(0).delta = layerCfg.firstLayerZ;
+	layerloops.reserve(layerloops.size() + sliceCount);
 	
 	for (size_t sliceId = 0; sliceId < sliceCount; sliceId++) {
 		tick();
-		LayerLoops::Layer currentLayer(layerloops.layerMeasure.createAttributes());
+		//build the layer in place rather than copying it in when done
+		layerloops.push_back(LayerLoops::Layer(
+				layerloops.layerMeasure.createAttributes()));
+		LayerLoops::Layer& currentLayer = layerloops.back();
 		layerloops.layerMeasure.getLayerAttributes(currentLayer.getIndex()) = 
 				LayerMeasure::LayerAttributes(
 				layerloops.layerMeasure.sliceIndexToHeight(sliceId), 
@@ -40,11 +44,13 @@ void Slicer::generateLoops(const Segmenter& seg, LayerLoops& layerloops) {
 		 into lists of loops.
 		 */
 		outlinesForSlice(seg, sliceId, segments);
+		currentLayer.reserve(segments.size());
 		//convert all SegmentTables into loops
 		for(SegmentTable::iterator it = segments.begin();
 				it != segments.end();
 				++it){
-			Loop currentLoop;
+			currentLayer.push_back(Loop());
+			Loop& currentLoop = currentLayer.back();
 			Loop::cw_iterator iter = currentLoop.clockwiseEnd();
 			//convert current SegmentTable into a loop
 			for(std::vector<Segment2Type>::iterator it2 = it->begin(); 
@@ -56,11 +62,7 @@ void Slicer::generateLoops(const Segmenter& seg, LayerLoops& layerloops) {
 			if(!it->empty())
 				//add point 0
 				iter = currentLoop.insertPointAfter(it->begin()->a, iter);
-			//add the loop to the current layer
-			currentLayer.push_back(currentLoop);
 		}
-		//finally, add the loop layer to the new data structure
-		layerloops.push_back(currentLayer);
 	}
 //	Scalar gridSpacing = layerCfg.layerW * layerCfg.gridSpacingMultiplier;
 //	Limits limits = seg.readLimits();
@@ -1,4 +1,5 @@
-#include <list>
+#include <vector>
+#include <algorithm>
 
 #include "slicer_loops.h"
 
@@ -21,13 +22,16 @@ void LayerLoops::Layer::push_back(const Loop& value){
 	loops.push_back(value);
 }
 void LayerLoops::Layer::push_front(const Loop& value){
-	loops.push_front(value);
+	loops.insert(loops.begin(), value);
+}
+Loop& LayerLoops::Layer::back(){
+	return loops.back();
 }
 void LayerLoops::Layer::pop_back(){
 	loops.pop_back();
 }
 void LayerLoops::Layer::pop_front(){
-	loops.pop_front();
+	loops.erase(loops.begin());
 }
 LayerLoops::loop_iterator LayerLoops::Layer::insert(loop_iterator at, 
 		const Loop& value){
@@ -41,12 +45,18 @@ LayerLoops::loop_iterator LayerLoops::Layer::erase(loop_iterator from,
 	return loops.erase(from, to);
 }
 bool LayerLoops::Layer::empty() const { return loops.empty(); }
+size_t LayerLoops::Layer::size() const { return loops.size(); }
+void LayerLoops::Layer::reserve(size_t count) { loops.reserve(count); }
 const LayerLoops::LoopList& LayerLoops::Layer::readLoops() const {
 	return loops;
 }
 layer_measure_index_t LayerLoops::Layer::getIndex() const {
 	return measure_index;
 }
+void LayerLoops::Layer::swap(Layer& other) {
+	loops.swap(other.loops);
+	std::swap(measure_index, other.measure_index);
+}
 
 LayerLoops::LayerLoops(Scalar firstLayerZ, Scalar layerH, Scalar layerW) : 
 		layerMeasure(firstLayerZ, layerH, layerW) {}
@@ -66,13 +76,16 @@ void LayerLoops::push_back(const Layer& value){
 	layers.push_back(value);
 }
 void LayerLoops::push_front(const Layer& value){
-	layers.push_front(value);
+	layers.insert(layers.begin(), value);
+}
+LayerLoops::Layer& LayerLoops::back(){
+	return layers.back();
 }
 void LayerLoops::pop_back(){
 	layers.pop_back();
 }
 void LayerLoops::pop_front(){
-	layers.pop_front();
+	layers.erase(layers.begin());
 }
 LayerLoops::layer_iterator LayerLoops::insert(layer_iterator at, 
 		const Layer& value){
@@ -86,6 +99,13 @@ LayerLoops::layer_iterator LayerLoops::erase(layer_iterator from,
 	return layers.erase(from, to);
 }
 bool LayerLoops::empty() const { return layers.empty(); }
+LayerLoops::Layer& LayerLoops::operator [](size_t index) {
+	return layers[index];
+}
+const LayerLoops::Layer& LayerLoops::operator [](size_t index) const {
+	return layers[index];
+}
+void LayerLoops::reserve(size_t count) { layers.reserve(count); }
 const LayerLoops::LayerList& LayerLoops::readLayers() const {
 	return layers;
 }
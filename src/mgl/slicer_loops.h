@@ -11,15 +11,24 @@
 #include "mgl.h"
 #include "grid.h"
 #include "loop_path.h"
-#include <list>
+#include <vector>
 
 namespace mgl {
 
+/**
+ @brief Outlines for every layer of a model, in ascending order
+ 
+ Layers are stored contiguously and may be addressed by index. A layer's 
+ index is the order in which it was added and does not change so long as 
+ layers are only appended. This permits stages to process layers 
+ independently (and in parallel) by index. Loops within a layer are 
+ likewise stored contiguously.
+ */
 class LayerLoops{	
 public:
 	class Layer;
-	typedef std::list<Loop> LoopList;
-	typedef std::list<Layer> LayerList;
+	typedef std::vector<Loop> LoopList;
+	typedef std::vector<Layer> LayerList;
 	typedef LoopList::iterator loop_iterator;
 	typedef LayerList::iterator layer_iterator;
 	typedef LoopList::const_iterator const_loop_iterator;
@@ -34,14 +43,19 @@ public:
 		const_loop_iterator end() const;
 		void push_back(const Loop& value);
 		void push_front(const Loop& value);
+		Loop& back();
 		void pop_back();
 		void pop_front();
 		loop_iterator insert(loop_iterator at, const Loop& value);
 		loop_iterator erase(loop_iterator at);
 		loop_iterator erase(loop_iterator from, loop_iterator to);
 		bool empty() const;
+		size_t size() const;
+		void reserve(size_t count);
 		const LoopList& readLoops() const;
 		layer_measure_index_t getIndex() const;
+		/// exchange loops and index with other without copying loops
+		void swap(Layer& other);
 	private:
 		LoopList loops;
 		layer_measure_index_t measure_index;
@@ -53,12 +67,17 @@ public:
 	const_layer_iterator end() const;
 	void push_back(const Layer& value);
 	void push_front(const Layer& value);
+	Layer& back();
 	void pop_back();
 	void pop_front();
 	layer_iterator insert(layer_iterator at, const Layer& value);
 	layer_iterator erase(layer_iterator at);
 	layer_iterator erase(layer_iterator from, layer_iterator to);
 	bool empty() const;
+	/// access layer at index, undefined if index >= size()
+	Layer& operator [](size_t index);
+	const Layer& operator [](size_t index) const;
+	void reserve(size_t count);
 	
 	const LayerList& readLayers() const;
 
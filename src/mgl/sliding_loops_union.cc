@@ -0,0 +1,56 @@
+/*
+ * File:   sliding_loops_union.cc
+ * Author: Dev
+ */
+
+#include "sliding_loops_union.h"
+
+namespace mgl {
+
+void SlidingLoopsUnion::push(const IntLoopList& loops) {
+	backEntries.push_back(&loops);
+	loopsUnion(backUnion, loops);
+}
+
+void SlidingLoopsUnion::pop() {
+	if(frontUnions.empty())
+		transfer();
+	if(!frontUnions.empty())
+		frontUnions.pop_back();
+}
+
+void SlidingLoopsUnion::result(IntLoopList& dest) const {
+	if(frontUnions.empty()) {
+		dest = backUnion;
+	} else if(backEntries.empty()) {
+		dest = frontUnions.back();
+	} else {
+		loopsUnion(dest, frontUnions.back(), backUnion);
+	}
+}
+
+void SlidingLoopsUnion::clear() {
+	backEntries.clear();
+	backUnion.clear();
+	frontUnions.clear();
+}
+
+void SlidingLoopsUnion::transfer() {
+	//newest entry first, so the oldest ends up on top with the union of all
+	frontUnions.resize(backEntries.size());
+	std::vector<IntLoopList>::iterator front = frontUnions.begin();
+	for(std::vector<const IntLoopList*>::reverse_iterator entry = 
+			backEntries.rbegin(); entry != backEntries.rend(); 
+			++entry, ++front) {
+		if(front == frontUnions.begin()) {
+			front->clear();
+			loopsUnion(*front, **entry);
+		} else
+			loopsUnion(*front, *(front - 1), **entry);
+	}
+	backEntries.clear();
+	backUnion.clear();
+}
+
+}
+
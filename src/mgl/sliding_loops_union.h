@@ -0,0 +1,52 @@
+/*
+ * File:   sliding_loops_union.h
+ * Author: Dev
+ *
+ * Union of a moving window of loop lists
+ */
+
+#ifndef SLIDING_LOOPS_UNION_H
+#define	SLIDING_LOOPS_UNION_H
+
+#include <vector>
+
+#include "loop_utils.h"
+#include "clipper.h"
+
+namespace mgl {
+
+/**
+ @brief Union of a window of loop lists that moves forward one at a time
+ 
+ Loop lists enter at the back and leave from the front, like a queue. 
+ Union cannot be undone, so the window is kept as two stacks: one holding 
+ the union of everything pushed since the last transfer, the other holding 
+ for each older entry the union of it and all entries after it. Each entry 
+ takes part in a constant number of unions over its lifetime instead of 
+ one per window it belongs to.
+ 
+ Only pointers to pushed lists are kept until they are folded into a 
+ union, so pushed lists must not change while in the window.
+ */
+class SlidingLoopsUnion {
+public:
+	/// add @a loops as the newest entry
+	void push(const IntLoopList& loops);
+	/// drop the oldest entry
+	void pop();
+	/// union of all entries now in the window
+	void result(IntLoopList& dest) const;
+	size_t size() const { return frontUnions.size() + backEntries.size(); }
+	void clear();
+private:
+	void transfer();
+	
+	std::vector<const IntLoopList*> backEntries; //< newest entries, oldest first
+	IntLoopList backUnion;
+	std::vector<IntLoopList> frontUnions; //< oldest entry at the back
+};
+
+}
+
+#endif	/* SLIDING_LOOPS_UNION_H */
+
@@ -10,6 +10,9 @@
 #include "mgl/clipper.h"
 #include "mgl/ScadDebugFile.h"
 #include "mgl/insets.h"
+#include "mgl/loop_utils.h"
+#include "mgl/sliding_loops_union.h"
+#include "mgl/layer_bitmap.h"
 
 CPPUNIT_TEST_SUITE_REGISTRATION( ClipperTestCase );
 
@@ -165,3 +168,319 @@ color([0,0,1,0])loop_segments3(out_segments_3);
 //	ScadTubeFile::segment3(cout, "", "out_segments", outSegs, 0, 0);
 
 }
+
+
+void ClipperTestCase::testMultiOffset()
+{
+	//a square with a notch and a square hole
+	ClipperLib::Polygon outer;
+	outer.push_back(ClipperLib::IntPoint(0, 0));
+	outer.push_back(ClipperLib::IntPoint(100000, 0));
+	outer.push_back(ClipperLib::IntPoint(100000, 100000));
+	outer.push_back(ClipperLib::IntPoint(60000, 100000));
+	outer.push_back(ClipperLib::IntPoint(50000, 70000));
+	outer.push_back(ClipperLib::IntPoint(40000, 100000));
+	outer.push_back(ClipperLib::IntPoint(0, 100000));
+	ClipperLib::Polygon hole;
+	hole.push_back(ClipperLib::IntPoint(30000, 30000));
+	hole.push_back(ClipperLib::IntPoint(30000, 50000));
+	hole.push_back(ClipperLib::IntPoint(50000, 50000));
+	hole.push_back(ClipperLib::IntPoint(50000, 30000));
+	ClipperLib::Polygons in_polys;
+	in_polys.push_back(outer);
+	in_polys.push_back(hole);
+
+	vector<double> deltas;
+	deltas.push_back(-5000);
+	deltas.push_back(2500);
+	deltas.push_back(0);
+	deltas.push_back(-12000);
+
+	ClipperLib::JoinType joins[] = { ClipperLib::jtSquare, ClipperLib::jtMiter };
+	for (size_t j = 0; j < 2; ++j) {
+		vector<ClipperLib::Polygons> multi;
+		OffsetPolygons(in_polys, multi, deltas, joins[j], 2.0);
+		CPPUNIT_ASSERT_EQUAL(deltas.size(), multi.size());
+		//every level must match a separate offset exactly
+		for (size_t i = 0; i < deltas.size(); ++i) {
+			ClipperLib::Polygons single;
+			OffsetPolygons(in_polys, single, deltas[i], joins[j], 2.0);
+			CPPUNIT_ASSERT_EQUAL(single.size(), multi[i].size());
+			for (size_t p = 0; p < single.size(); ++p) {
+				CPPUNIT_ASSERT_EQUAL(single[p].size(), multi[i][p].size());
+				for (size_t q = 0; q < single[p].size(); ++q) {
+					CPPUNIT_ASSERT(single[p][q].X == multi[i][p][q].X);
+					CPPUNIT_ASSERT(single[p][q].Y == multi[i][p][q].Y);
+				}
+			}
+		}
+	}
+}
+
+static double pointToRingDistance(const ClipperLib::IntPoint& pt, 
+		const ClipperLib::Polygon& ring)
+{
+	double best = numeric_limits<double>::max();
+	for (size_t i = 0; i < ring.size(); ++i) {
+		const ClipperLib::IntPoint& a = ring[i];
+		const ClipperLib::IntPoint& b = ring[(i + 1) % ring.size()];
+		double dx = double(b.X - a.X), dy = double(b.Y - a.Y);
+		double px = double(pt.X - a.X), py = double(pt.Y - a.Y);
+		double t = (px * dx + py * dy) / (dx * dx + dy * dy);
+		t = std::max(0.0, std::min(1.0, t));
+		double ex = px - t * dx, ey = py - t * dy;
+		best = std::min(best, sqrt(ex * ex + ey * ey));
+	}
+	return best;
+}
+
+static ClipperLib::Polygon square(ClipperLib::long64 x0, ClipperLib::long64 y0, 
+		ClipperLib::long64 x1, ClipperLib::long64 y1) {
+	ClipperLib::Polygon result;
+	result.push_back(ClipperLib::IntPoint(x0, y0));
+	result.push_back(ClipperLib::IntPoint(x1, y0));
+	result.push_back(ClipperLib::IntPoint(x1, y1));
+	result.push_back(ClipperLib::IntPoint(x0, y1));
+	return result;
+}
+
+void ClipperTestCase::testSimplify()
+{
+	//a finely divided circle of radius 10 and a speck smaller than the 
+	//tolerance, in clipper units
+	ClipperLib::Polygon circle;
+	for (int i = 0; i < 720; ++i) {
+		double angle = i * M_PI / 360;
+		circle.push_back(ClipperLib::IntPoint(
+				ClipperLib::long64(200000 * cos(angle)), 
+				ClipperLib::long64(200000 * sin(angle))));
+	}
+	ClipperLib::Polygon speck;
+	speck.push_back(ClipperLib::IntPoint(500000, 500000));
+	speck.push_back(ClipperLib::IntPoint(500100, 500000));
+	speck.push_back(ClipperLib::IntPoint(500000, 500100));
+	IntLoopList loops;
+	loops.push_back(circle);
+	loops.push_back(speck);
+	CPPUNIT_ASSERT_EQUAL(size_t(723), loopsVertexCount(loops));
+
+	//under budget, nothing happens
+	CPPUNIT_ASSERT(!loopsSimplifyToBudget(loops, 1000, 0.05));
+	CPPUNIT_ASSERT_EQUAL(size_t(2), loops.size());
+	CPPUNIT_ASSERT(!loopsSimplifyToBudget(loops, 0, 0.05));
+
+	//0.05 is 1000 clipper units
+	CPPUNIT_ASSERT(loopsSimplifyToBudget(loops, 100, 0.05));
+	CPPUNIT_ASSERT_EQUAL(size_t(1), loops.size());
+	CPPUNIT_ASSERT(loops[0].size() >= 3);
+	CPPUNIT_ASSERT(loops[0].size() < 100);
+	for (size_t i = 0; i < circle.size(); ++i)
+		CPPUNIT_ASSERT(pointToRingDistance(circle[i], loops[0]) <= 1000);
+
+	//a budget the first tolerance cannot meet raises the tolerance
+	loops.clear();
+	loops.push_back(circle);
+	CPPUNIT_ASSERT(loopsSimplifyToBudget(loops, 8, 0.05));
+	CPPUNIT_ASSERT_EQUAL(size_t(1), loops.size());
+	CPPUNIT_ASSERT(loopsVertexCount(loops) <= 8);
+
+	//loops simplified into each other come out merged
+	IntLoopList overlap;
+	overlap.push_back(square(0, 0, 2000, 2000));
+	overlap.push_back(square(1000, 1000, 3000, 3000));
+	loopsNonZeroUnion(overlap);
+	CPPUNIT_ASSERT_EQUAL(size_t(1), overlap.size());
+	CPPUNIT_ASSERT_EQUAL(size_t(8), overlap[0].size());
+}
+
+void ClipperTestCase::testBitmap()
+{
+	//a 10 by 10 cell square with a 4 by 4 cell hole punched out
+	const ClipperLib::long64 cell = 1000;
+	IntLoopList outer, hole;
+	outer.push_back(square(0, 0, 10 * cell, 10 * cell));
+	hole.push_back(square(3 * cell, 3 * cell, 7 * cell, 7 * cell));
+	IntLoopList result;
+	bitmapDifference(result, outer, hole, cell);
+	CPPUNIT_ASSERT_EQUAL(size_t(2), result.size());
+	double area = 0;
+	size_t outerCount = 0;
+	for (size_t i = 0; i < result.size(); ++i) {
+		//only the corners are kept
+		CPPUNIT_ASSERT_EQUAL(size_t(4), result[i].size());
+		if (ClipperLib::Orientation(result[i]))
+			++outerCount;
+		area += ClipperLib::Area(result[i]);
+	}
+	CPPUNIT_ASSERT_EQUAL(size_t(1), outerCount);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(84.0 * cell * cell, area, 1.0);
+
+	//same as the polygon difference
+	IntLoopList exact;
+	loopsDifference(exact, outer, hole);
+	double exactArea = 0;
+	for (size_t i = 0; i < exact.size(); ++i)
+		exactArea += ClipperLib::Area(exact[i]);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(exactArea, area, 1.0);
+
+	//cells touching at a corner come out as separate loops
+	ClipperLib::IntRect bounds = { 0, 0, 2 * cell, 2 * cell };
+	LayerBitmap bitmap(bounds, cell);
+	IntLoopList diagonal;
+	diagonal.push_back(square(0, 0, cell, cell));
+	diagonal.push_back(square(cell, cell, 2 * cell, 2 * cell));
+	bitmap.draw(diagonal);
+	CPPUNIT_ASSERT(bitmap.filled(0, 0));
+	CPPUNIT_ASSERT(!bitmap.filled(1, 0));
+	CPPUNIT_ASSERT(bitmap.filled(1, 1));
+	bitmap.contours(result);
+	CPPUNIT_ASSERT_EQUAL(size_t(2), result.size());
+	CPPUNIT_ASSERT(ClipperLib::Orientation(result[0]));
+	CPPUNIT_ASSERT(ClipperLib::Orientation(result[1]));
+
+	//booleans need the same frame
+	ClipperLib::IntRect otherBounds = { 0, 0, 5 * cell, 5 * cell };
+	LayerBitmap other(otherBounds, cell);
+	CPPUNIT_ASSERT_THROW(bitmap |= other, mgl::Exception);
+	LayerBitmap same(bounds, cell);
+	same.draw(diagonal);
+	bitmap.subtract(same);
+	CPPUNIT_ASSERT(bitmap.empty());
+}
+
+static void clipperDirect(IntLoopList& dest, const IntLoopList& subject, 
+		const IntLoopList& apply, ClipperLib::ClipType type) {
+	ClipperLib::Clipper clip;
+	clip.AddPolygons(subject, ClipperLib::ptSubject);
+	clip.AddPolygons(apply, ClipperLib::ptClip);
+	clip.Execute(type, dest);
+}
+
+static void assertSameLoops(const IntLoopList& expected, 
+		const IntLoopList& actual) {
+	CPPUNIT_ASSERT_EQUAL(expected.size(), actual.size());
+	for (size_t i = 0; i < expected.size(); ++i) {
+		CPPUNIT_ASSERT_EQUAL(expected[i].size(), actual[i].size());
+		for (size_t j = 0; j < expected[i].size(); ++j) {
+			CPPUNIT_ASSERT_EQUAL(expected[i][j].X, actual[i][j].X);
+			CPPUNIT_ASSERT_EQUAL(expected[i][j].Y, actual[i][j].Y);
+		}
+	}
+}
+
+void ClipperTestCase::testPrunedLoops()
+{
+	//a square with a hole, one square across its edge, one inside its 
+	//hole and one off to the side
+	IntLoopList subject, apply;
+	subject.push_back(square(0, 0, 10000, 10000));
+	subject.push_back(square(4000, 6000, 6000, 4000));
+	apply.push_back(square(8000, 8000, 12000, 12000));
+	apply.push_back(square(4500, 4500, 5500, 5500));
+	apply.push_back(square(20000, 0, 22000, 2000));
+
+	IntLoopList expected, result;
+	resetLoopOpStats();
+	clipperDirect(expected, subject, apply, ClipperLib::ctDifference);
+	loopsDifference(result, subject, apply);
+	assertSameLoops(expected, result);
+	//only the square off to the side touches no subject loop
+	CPPUNIT_ASSERT_EQUAL(size_t(1), loopOpStats().prunedLoops);
+
+	clipperDirect(expected, subject, apply, ClipperLib::ctIntersection);
+	loopsIntersection(result, subject, apply);
+	assertSameLoops(expected, result);
+
+	//the cached bounds give the same results
+	CachedLoopList cached;
+	cached.assign(subject);
+	loopsDifference(result, cached, apply);
+	clipperDirect(expected, subject, apply, ClipperLib::ctDifference);
+	assertSameLoops(expected, result);
+	result = apply;
+	loopsIntersection(result, cached);
+	clipperDirect(expected, apply, subject, ClipperLib::ctIntersection);
+	assertSameLoops(expected, result);
+
+	//nothing left to subtract once the far loop is pruned
+	IntLoopList far;
+	far.push_back(square(20000, 0, 22000, 2000));
+	far.push_back(square(0, 20000, 2000, 22000));
+	resetLoopOpStats();
+	loopsDifference(result, subject, far);
+	CPPUNIT_ASSERT_EQUAL(size_t(1), loopOpStats().singleOperandRuns);
+	CPPUNIT_ASSERT_EQUAL(size_t(2), loopOpStats().prunedLoops);
+	CPPUNIT_ASSERT_EQUAL(size_t(0), loopOpStats().clipperRuns);
+}
+
+/// the window as one union against the sliding one, which may order and 
+/// start its loops differently
+static void assertWindowUnion(const vector<IntLoopList>& entries, 
+		size_t first, size_t end, const SlidingLoopsUnion& sliding) {
+	IntLoopList direct, slid, difference;
+	for (size_t entry = first; entry < end; ++entry)
+		loopsUnion(direct, entries[entry]);
+	sliding.result(slid);
+	CPPUNIT_ASSERT_EQUAL(end - first, sliding.size());
+	CPPUNIT_ASSERT_EQUAL(direct.empty(), slid.empty());
+	clipperDirect(difference, direct, slid, ClipperLib::ctXor);
+	CPPUNIT_ASSERT(difference.empty());
+}
+
+void ClipperTestCase::testSlidingUnion()
+{
+	//squares walking right, each layer overlapping the next, with one 
+	//empty layer and one holding two disjoint squares
+	vector<IntLoopList> entries(12);
+	for (size_t entry = 0; entry < entries.size(); ++entry) {
+		if (entry == 5)
+			continue;
+		ClipperLib::long64 x = 1500 * entry;
+		entries[entry].push_back(square(x, 0, x + 2000, 2000 + 300 * entry));
+		if (entry == 8)
+			entries[entry].push_back(square(x, 5000, x + 1000, 6000));
+	}
+
+	SlidingLoopsUnion sliding;
+	assertWindowUnion(entries, 0, 0, sliding);
+	//a window of three sliding along, checked after every push and pop, 
+	//so also right after each pop that moves the back stack to the front
+	size_t first = 0;
+	size_t end = 0;
+	for (; end < 3; ++end) {
+		sliding.push(entries[end]);
+		assertWindowUnion(entries, first, end + 1, sliding);
+	}
+	for (; end < entries.size(); ++end) {
+		sliding.pop();
+		++first;
+		assertWindowUnion(entries, first, end, sliding);
+		sliding.push(entries[end]);
+		assertWindowUnion(entries, first, end + 1, sliding);
+	}
+	//drain it one at a time
+	while (first < end) {
+		sliding.pop();
+		++first;
+		assertWindowUnion(entries, first, end, sliding);
+	}
+
+	//a window that grows and shrinks unevenly
+	sliding.clear();
+	first = end = 0;
+	const size_t pushes[] = {4, 1, 3, 2, 2};
+	const size_t pops[] = {2, 1, 3, 1, 4};
+	for (size_t step = 0; step < 5; ++step) {
+		for (size_t push = 0; push < pushes[step]; ++push) {
+			sliding.push(entries[end++]);
+			assertWindowUnion(entries, first, end, sliding);
+		}
+		for (size_t pop = 0; pop < pops[step]; ++pop) {
+			sliding.pop();
+			++first;
+			assertWindowUnion(entries, first, end, sliding);
+		}
+	}
+	CPPUNIT_ASSERT_EQUAL(size_t(1), sliding.size());
+}
+
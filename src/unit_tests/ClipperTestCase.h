@@ -14,6 +14,11 @@ private:
      //   CPPUNIT_TEST(test_conversion);
      //   CPPUNIT_TEST(testSimpleClipper);
         CPPUNIT_TEST(testSimpleInset);
+        CPPUNIT_TEST(testMultiOffset);
+        CPPUNIT_TEST(testSimplify);
+        CPPUNIT_TEST(testBitmap);
+        CPPUNIT_TEST(testPrunedLoops);
+        CPPUNIT_TEST(testSlidingUnion);
     CPPUNIT_TEST_SUITE_END();
 
 
@@ -25,6 +30,11 @@ protected:
   void test_conversion();
   void testSimpleInset();
   void testSimpleClipper();
+  void testMultiOffset();
+  void testSimplify();
+  void testBitmap();
+  void testPrunedLoops();
+  void testSlidingUnion();
 };
 
 #endif
@@ -18,17 +18,14 @@ void GridTestCase::testGridRangesToOpenPaths() {
 	Grid grid;
 
 	ScalarRangeTable rays;
-	rays.resize(2);
 
-	ScalarRangeTable::iterator ray = rays.begin();
+	rays.addRow();
+	rays.push_back(ScalarRange(0, 1));
+	rays.push_back(ScalarRange(2, 3));
 
-	ray->push_back(ScalarRange(0, 1));
-	ray->push_back(ScalarRange(2, 3));
-
-	++ray;
-
-	ray->push_back(ScalarRange(0, 1));
-	ray->push_back(ScalarRange(2, 3));
+	rays.addRow();
+	rays.push_back(ScalarRange(0, 1));
+	rays.push_back(ScalarRange(2, 3));
 
 	vector<Scalar> values;
 	values.push_back(0);
@@ -76,3 +73,150 @@ void GridTestCase::testGridRangesToOpenPaths() {
 	
 
 	
+
+void GridTestCase::testRangeTable() {
+	ScalarRangeTable src;
+	src.addRow();
+	src.push_back(ScalarRange(0, 4));
+	src.addRow();
+	src.addRow();
+	src.push_back(ScalarRange(0, 1));
+	src.push_back(ScalarRange(2, 5));
+
+	CPPUNIT_ASSERT_EQUAL((size_t)3, src.size());
+	CPPUNIT_ASSERT_EQUAL((size_t)3, src.rangeCount());
+	CPPUNIT_ASSERT(src[1].empty());
+	CPPUNIT_ASSERT_EQUAL((size_t)2, src[2].size());
+	CPPUNIT_ASSERT_EQUAL(5.0, (Scalar)src[2].back().max);
+
+	ScalarRangeTable del;
+	del.addRow();
+	del.push_back(ScalarRange(1, 2));
+	del.resize(3);
+	del.append(vector<ScalarRange>(1, ScalarRange(0, 3)));
+
+	ScalarRangeTable diff;
+	rangeTableDifference(src, del, diff);
+	CPPUNIT_ASSERT_EQUAL((size_t)3, diff.size());
+	CPPUNIT_ASSERT_EQUAL((size_t)2, diff[0].size());
+	CPPUNIT_ASSERT_EQUAL(0.0, (Scalar)diff[0][0].min);
+	CPPUNIT_ASSERT_EQUAL(1.0, (Scalar)diff[0][0].max);
+	CPPUNIT_ASSERT_EQUAL(2.0, (Scalar)diff[0][1].min);
+	CPPUNIT_ASSERT_EQUAL(4.0, (Scalar)diff[0][1].max);
+	CPPUNIT_ASSERT(diff[1].empty());
+	CPPUNIT_ASSERT_EQUAL((size_t)1, diff[2].size());
+	CPPUNIT_ASSERT_EQUAL(3.0, (Scalar)diff[2][0].min);
+	CPPUNIT_ASSERT_EQUAL(5.0, (Scalar)diff[2][0].max);
+
+	// the buffers are reused by the next result
+	rangeTableIntersection(src, del, diff);
+	CPPUNIT_ASSERT_EQUAL((size_t)3, diff.size());
+	CPPUNIT_ASSERT_EQUAL((size_t)3, diff.rangeCount());
+	CPPUNIT_ASSERT_EQUAL((size_t)1, diff[0].size());
+	CPPUNIT_ASSERT_EQUAL((size_t)2, diff[2].size());
+	CPPUNIT_ASSERT_EQUAL(2.0, (Scalar)diff[2][1].min);
+	CPPUNIT_ASSERT_EQUAL(3.0, (Scalar)diff[2][1].max);
+}
+
+void GridTestCase::testSubSampleView() {
+	Grid grid;
+	GridRanges ranges;
+	for (size_t line = 0; line < 7; line++) {
+		ranges.xRays.addRow();
+		ranges.xRays.push_back(ScalarRange(line, line + 1));
+		ranges.yRays.addRow();
+	}
+	ranges.yRays.push_back(ScalarRange(0, 1));
+
+	GridRanges copied;
+	grid.subSample(ranges, 2, copied);
+	GridRangesView viewed = grid.subSample(ranges, 2);
+
+	CPPUNIT_ASSERT_EQUAL(copied.xRays.size(), viewed.xRays.size());
+	CPPUNIT_ASSERT_EQUAL(copied.yRays.size(), viewed.yRays.size());
+	CPPUNIT_ASSERT_EQUAL((size_t)3, viewed.xRays.rangeCount());
+	CPPUNIT_ASSERT_EQUAL((size_t)1, viewed.yRays.rangeCount());
+	for (size_t line = 0; line < 7; line++) {
+		CPPUNIT_ASSERT_EQUAL(line % 3 == 0, !viewed.xRays[line].empty());
+		CPPUNIT_ASSERT_EQUAL(copied.xRays[line].size(), 
+				viewed.xRays[line].size());
+		if (!viewed.xRays[line].empty()) {
+			CPPUNIT_ASSERT_EQUAL((Scalar)copied.xRays[line][0].min,
+					(Scalar)viewed.xRays[line][0].min);
+		}
+	}
+	CPPUNIT_ASSERT(!viewed.yRays[6].empty());
+
+	// range ops read views as they would tables
+	ScalarRangeTable diff;
+	rangeTableDifference(ranges.xRays, viewed.xRays, diff);
+	CPPUNIT_ASSERT_EQUAL((size_t)4, diff.rangeCount());
+	CPPUNIT_ASSERT(diff[0].empty());
+	CPPUNIT_ASSERT(!diff[1].empty());
+}
+
+static Loop loopThrough(const Scalar* coords, size_t count) {
+	Loop loop;
+	Loop::cw_iterator at = loop.clockwiseEnd();
+	for (size_t point = 0; point < count; point++)
+		at = loop.insertPointAfter(
+				Point2Type(coords[2 * point], coords[2 * point + 1]), at);
+	return loop;
+}
+
+static void assertRange(const ScalarRangeTable& table, size_t line, 
+		size_t range, Scalar min, Scalar max) {
+	CPPUNIT_ASSERT(range < table[line].size());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(min, (Scalar)table[line][range].min, 1e-9);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(max, (Scalar)table[line][range].max, 1e-9);
+}
+
+void GridTestCase::testRaysThroughVertices() {
+	// a vertex on a ray belongs to the segment above it
+	vector<Scalar> values;
+	for (size_t line = 0; line <= 4; line++)
+		values.push_back(line);
+
+	// flat bottom and top on rays 0 and 4, vertices (6, 2) and (2, 2) 
+	// on ray 2 where the outline crosses it
+	const Scalar arrow[] = {0, 0, 4, 0, 6, 2, 4, 4, 0, 4, 2, 2};
+	list<Loop> loops(1, loopThrough(arrow, 6));
+	ScalarRangeTable xRays;
+	castRaysOnSliceAlongX(loops, values, -10, 10, xRays);
+	CPPUNIT_ASSERT_EQUAL((size_t)5, xRays.size());
+	for (size_t line = 0; line < 4; line++)
+		CPPUNIT_ASSERT_EQUAL((size_t)1, xRays[line].size());
+	// the bottom edge is cut by the sides above it, the top edge by none
+	assertRange(xRays, 0, 0, 0, 4);
+	assertRange(xRays, 1, 0, 1, 5);
+	assertRange(xRays, 2, 0, 2, 6);
+	assertRange(xRays, 3, 0, 1, 5);
+	CPPUNIT_ASSERT(xRays[4].empty());
+
+	// along y, vertices on a ray belong to the segment to their right
+	ScalarRangeTable yRays;
+	castRaysOnSliceAlongY(loops, values, -10, 10, yRays);
+	CPPUNIT_ASSERT_EQUAL((size_t)5, yRays.size());
+	// x = 0 touches the left vertices and the ends of both flat edges
+	CPPUNIT_ASSERT_EQUAL((size_t)2, yRays[0].size());
+	assertRange(yRays, 0, 0, 0, 0);
+	assertRange(yRays, 0, 1, 4, 4);
+	// x = 2 passes the notch vertex, whose segments are both to its left
+	CPPUNIT_ASSERT_EQUAL((size_t)1, yRays[2].size());
+	assertRange(yRays, 2, 0, 0, 4);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, yRays[4].size());
+	assertRange(yRays, 4, 0, 0, 4);
+
+	// a diamond only touching rays 0 and 4 with a vertex: the bottom one 
+	// leaves an empty range, the top one nothing
+	const Scalar diamond[] = {3, 0, 6, 2, 3, 4, 0, 2};
+	list<Loop> diamonds(1, loopThrough(diamond, 4));
+	ScalarRangeTable touched;
+	castRaysOnSliceAlongX(diamonds, values, -10, 10, touched);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, touched[0].size());
+	assertRange(touched, 0, 0, 3, 3);
+	assertRange(touched, 1, 0, 1.5, 4.5);
+	assertRange(touched, 2, 0, 0, 6);
+	assertRange(touched, 3, 0, 1.5, 4.5);
+	CPPUNIT_ASSERT(touched[4].empty());
+}
@@ -9,6 +9,9 @@ class GridTestCase : public CPPUNIT_NS::TestFixture
 {
 	CPPUNIT_TEST_SUITE( GridTestCase );
 	CPPUNIT_TEST( testGridRangesToOpenPaths );
+	CPPUNIT_TEST( testRangeTable );
+	CPPUNIT_TEST( testSubSampleView );
+	CPPUNIT_TEST( testRaysThroughVertices );
     CPPUNIT_TEST_SUITE_END();
 
 
@@ -17,6 +20,9 @@ public:
 
 protected:
 	void testGridRangesToOpenPaths();
+	void testRangeTable();
+	void testSubSampleView();
+	void testRaysThroughVertices();
 
 };
 
@@ -300,31 +300,6 @@ void InsetsTestCase::testTriangleSpurFill() {
 	CPPUNIT_ASSERT_EQUAL(1, (int)spurs.size());
 }
 
-typedef pair<LineSegment2, LineSegment2> SegmentPair;
-bool VectorLess(const Vector2 &first, const Vector2 &second);
-
-bool SegLess(const LineSegment2 &first, const LineSegment2 &second);
-
-struct SegPairLess {
-	bool operator()(const SegmentPair first, const SegmentPair second) {
-		if (SegLess(first.first, second.first))
-			return true;
-		else if (SegLess(second.first, first.first))
-			return false;
-		else if (SegLess(first.second, second.second))
-			return true;
-		else 
-			return false;
-	}
-};
-
-typedef set<SegmentPair, SegPairLess> SegmentPairSet;
-typedef vector<LineSegment2> SegmentList;
-typedef basic_boxlist<LineSegment2> SegmentIndex;
-
-void findWallPairs(const Scalar span, const SegmentList segs,
-				   SegmentIndex &index, SegmentPairSet &walls);
-
 void InsetsTestCase::testFindWallPairs() {
 	Regioner regioner(config);
 
@@ -0,0 +1,154 @@
+#include <cppunit/config/SourcePrefix.h>
+#include <list>
+#include "UnitTestUtils.h"
+#include "LayerReuseTestCase.h"
+
+#include "mgl/layer_reuse.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION( LayerReuseTestCase );
+
+using namespace mgl;
+using namespace libthing;
+
+static const Scalar WIDTH = 0.4;
+
+/// a layer whose only outline is a square of side @a size, with its 
+/// last corner moved by @a nudge
+static LayerRegions squareLayer(Scalar size, Scalar nudge = 0) {
+    LayerRegions region;
+    Loop square;
+    Loop::cw_iterator at = square.insertPointAfter(Vector2(0, 0), 
+            square.clockwiseEnd());
+    at = square.insertPointAfter(Vector2(0, size), at);
+    at = square.insertPointAfter(Vector2(size, size), at);
+    at = square.insertPointAfter(Vector2(size, nudge), at);
+    region.outlines.push_back(square);
+    return region;
+}
+
+/// insets worked out for a layer, @a count of them
+static void setInsets(LayerRegions& region, size_t count) {
+    region.insetLoops.assign(count, region.outlines);
+}
+
+/// infill of one range, standing in for whatever a layer worked out
+static GridRanges markedInfill(Scalar mark) {
+    GridRanges infill;
+    infill.xRays.addRow();
+    infill.xRays.push_back(ScalarRange(mark, mark + 1));
+    return infill;
+}
+
+void LayerReuseTestCase::setUp() {
+    //nothing
+    std::cout << "\nNo Setup" << std::endl;
+}
+
+void LayerReuseTestCase::testShapes() {
+    LayerReuse reuse(5);
+
+    LayerRegions first = squareLayer(10);
+    CPPUNIT_ASSERT(!reuse.findInsets(0, first, WIDTH));
+    CPPUNIT_ASSERT(reuse.shape(0) != LayerReuse::NO_SHAPE);
+    setInsets(first, 3);
+    reuse.keepInsets(0, first);
+    CPPUNIT_ASSERT(!reuse.findSpurs(0, first));
+    first.spurLoops.assign(2, first.outlines);
+    reuse.keepSpurs(0, first);
+
+    //the same outline point for point takes everything
+    LayerRegions same = squareLayer(10);
+    CPPUNIT_ASSERT(reuse.findInsets(1, same, WIDTH));
+    CPPUNIT_ASSERT_EQUAL(reuse.shape(0), reuse.shape(1));
+    CPPUNIT_ASSERT_EQUAL((size_t)3, same.insetLoops.size());
+    CPPUNIT_ASSERT(reuse.findSpurs(1, same));
+    CPPUNIT_ASSERT_EQUAL((size_t)2, same.spurLoops.size());
+
+    //one corner off is another shape, with nothing kept yet
+    LayerRegions nudged = squareLayer(10, 0.1);
+    CPPUNIT_ASSERT(!reuse.findInsets(2, nudged, WIDTH));
+    CPPUNIT_ASSERT(reuse.shape(2) != reuse.shape(0));
+    CPPUNIT_ASSERT(nudged.insetLoops.empty());
+    CPPUNIT_ASSERT(!reuse.findSpurs(2, nudged));
+    CPPUNIT_ASSERT(nudged.spurLoops.empty());
+
+    //so is the same outline extruded wider
+    LayerRegions wider = squareLayer(10);
+    CPPUNIT_ASSERT(!reuse.findInsets(3, wider, 2 * WIDTH));
+    CPPUNIT_ASSERT(reuse.shape(3) != reuse.shape(0));
+    CPPUNIT_ASSERT(reuse.shape(3) != reuse.shape(2));
+
+    //keeping results for a shape that has them changes nothing
+    setInsets(same, 1);
+    reuse.keepInsets(1, same);
+    LayerRegions again = squareLayer(10);
+    CPPUNIT_ASSERT(reuse.findInsets(4, again, WIDTH));
+    CPPUNIT_ASSERT_EQUAL((size_t)3, again.insetLoops.size());
+
+    CPPUNIT_ASSERT_EQUAL((size_t)2, reuse.reusedInsets());
+    CPPUNIT_ASSERT_EQUAL((size_t)1, reuse.reusedSpurs());
+}
+
+void LayerReuseTestCase::testInfillContext() {
+    //shapes a a b a a a a, and layer 7 without insets
+    const Scalar sizes[] = {10, 10, 12, 10, 10, 10, 10};
+    LayerReuse reuse(8);
+    for (size_t layer = 0; layer < 7; ++layer) {
+        LayerRegions region = squareLayer(sizes[layer]);
+        reuse.findInsets(layer, region, WIDTH);
+    }
+    CPPUNIT_ASSERT_EQUAL(reuse.shape(0), reuse.shape(3));
+    CPPUNIT_ASSERT_EQUAL(LayerReuse::NO_SHAPE, reuse.shape(7));
+
+    GridRanges infill;
+    CPPUNIT_ASSERT(!reuse.findInfill(4, 1, 1, infill));
+    reuse.keepInfill(4, 1, 1, markedInfill(4));
+
+    //the same shape with the same shapes around it
+    CPPUNIT_ASSERT(reuse.findInfill(5, 1, 1, infill));
+    CPPUNIT_ASSERT_EQUAL((size_t)1, infill.xRays.rangeCount());
+    CPPUNIT_ASSERT_EQUAL(4.0, (Scalar)infill.xRays[0][0].min);
+
+    //the same shape under a different one, or with no layer above or 
+    //below, misses
+    GridRanges missed;
+    CPPUNIT_ASSERT(!reuse.findInfill(1, 1, 1, missed));
+    CPPUNIT_ASSERT(!reuse.findInfill(3, 1, 1, missed));
+    CPPUNIT_ASSERT(!reuse.findInfill(0, 1, 1, missed));
+    CPPUNIT_ASSERT(!reuse.findInfill(6, 1, 1, missed));
+    //as does a wider window that takes in layer 2
+    CPPUNIT_ASSERT(!reuse.findInfill(5, 3, 1, missed));
+    CPPUNIT_ASSERT(missed.xRays.empty());
+
+    //a layer without a shape neither takes nor keeps infill
+    reuse.keepInfill(7, 0, 0, markedInfill(7));
+    CPPUNIT_ASSERT(!reuse.findInfill(7, 0, 0, missed));
+    CPPUNIT_ASSERT_EQUAL((size_t)1, reuse.reusedInfills());
+}
+
+void LayerReuseTestCase::testEviction() {
+    //16 distinct shapes fill the default capacity
+    LayerReuse reuse(20);
+    for (size_t layer = 0; layer < 16; ++layer) {
+        LayerRegions region = squareLayer(10 + layer);
+        CPPUNIT_ASSERT(!reuse.findInsets(layer, region, WIDTH));
+        setInsets(region, 1);
+        reuse.keepInsets(layer, region);
+    }
+    //looking up the oldest makes it the most recently used
+    LayerRegions oldest = squareLayer(10);
+    CPPUNIT_ASSERT(reuse.findInsets(16, oldest, WIDTH));
+    CPPUNIT_ASSERT_EQUAL(reuse.shape(0), reuse.shape(16));
+
+    //the 17th distinct shape pushes out the second, now the least used
+    LayerRegions extra = squareLayer(30);
+    CPPUNIT_ASSERT(!reuse.findInsets(17, extra, WIDTH));
+    LayerRegions first = squareLayer(10);
+    CPPUNIT_ASSERT(reuse.findInsets(18, first, WIDTH));
+    LayerRegions second = squareLayer(11);
+    CPPUNIT_ASSERT(!reuse.findInsets(19, second, WIDTH));
+    CPPUNIT_ASSERT(second.insetLoops.empty());
+    //and comes back as a new shape
+    CPPUNIT_ASSERT(reuse.shape(19) != reuse.shape(1));
+    CPPUNIT_ASSERT(reuse.shape(19) != reuse.shape(17));
+}
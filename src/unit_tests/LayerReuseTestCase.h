@@ -0,0 +1,26 @@
+/* 
+ * File:   LayerReuseTestCase.h
+ * Author: Dev
+ */
+
+#ifndef LAYERREUSETESTCASE_H
+#define	LAYERREUSETESTCASE_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class LayerReuseTestCase : public CPPUNIT_NS::TestFixture {
+private:
+    CPPUNIT_TEST_SUITE( LayerReuseTestCase );
+    CPPUNIT_TEST( testShapes );
+    CPPUNIT_TEST( testInfillContext );
+    CPPUNIT_TEST( testEviction );
+    CPPUNIT_TEST_SUITE_END();
+public:
+    void setUp();
+protected:
+    void testShapes(); //only identical outlines share results
+    void testInfillContext(); //infill needs the same layers around it
+    void testEviction(); //least recently used results go first
+};
+
+#endif	/* LAYERREUSETESTCASE_H */
@@ -0,0 +1,174 @@
+#include <cppunit/config/SourcePrefix.h>
+#include <vector>
+#include <utility>
+#include "UnitTestUtils.h"
+#include "LayerSchedulerTestCase.h"
+
+#include "mgl/layer_scheduler.h"
+#include "mgl/mgl.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION( LayerSchedulerTestCase );
+
+using namespace mgl;
+using namespace std;
+
+typedef vector<pair<int, size_t> > RunLog;
+
+/// records which stage ran which layer, in the order they ran
+class RecordingStage : public LayerScheduler::Stage {
+public:
+    RecordingStage(int stageName, RunLog& runLog) 
+            : name(stageName), log(runLog) {}
+    void run(size_t layer) {
+#ifdef OMPFF
+#pragma omp critical (recordingStage)
+#endif
+        log.push_back(make_pair(name, layer));
+    }
+private:
+    int name;
+    RunLog& log;
+};
+
+class CountingListener : public LayerScheduler::Listener {
+public:
+    CountingListener() : count(0) {}
+    void taskDone() { ++count; }
+    size_t count;
+};
+
+/// position of @a layer of stage @a name in @a log, or log.size()
+static size_t runIndex(const RunLog& log, int name, size_t layer) {
+    for(size_t index = 0; index < log.size(); ++index) {
+        if(log[index].first == name && log[index].second == layer)
+            return index;
+    }
+    return log.size();
+}
+
+void LayerSchedulerTestCase::setUp() {
+    //nothing
+    std::cout << "\nNo Setup" << std::endl;
+}
+
+void LayerSchedulerTestCase::testNeighbourOrder() {
+    RunLog log;
+    RecordingStage first(0, log);
+    RecordingStage second(1, log);
+    RecordingStage third(2, log);
+    LayerScheduler scheduler;
+    CountingListener listener;
+    scheduler.setListener(&listener);
+    //second runs past both ends of first, third only over its middle
+    LayerScheduler::stage_id a = scheduler.addStage(first, 2, 8);
+    LayerScheduler::stage_id b = scheduler.addStage(second, 0, 10);
+    LayerScheduler::stage_id c = scheduler.addStage(third, 4, 6);
+    //first goes up the model one layer at a time
+    scheduler.addDependency(a, a, -1, -1);
+    //second waits for the same layer and two either side of first
+    scheduler.addDependency(b, a, -2, 2);
+    //third waits for the same layer of second and the three above it
+    scheduler.addDependency(c, b, 0, 3);
+    //and for first well below it, which is gone for layer 4
+    scheduler.addDependency(c, a, -3, -3);
+    //an empty window adds nothing
+    scheduler.addDependency(a, c, 1, 0);
+    CPPUNIT_ASSERT_EQUAL((size_t)18, scheduler.taskCount());
+
+    scheduler.run();
+
+    CPPUNIT_ASSERT_EQUAL((size_t)18, log.size());
+    CPPUNIT_ASSERT_EQUAL((size_t)18, listener.count);
+    for(size_t layer = 2; layer < 8; ++layer) {
+        CPPUNIT_ASSERT(runIndex(log, 0, layer) < log.size());
+        if(layer > 2)
+            CPPUNIT_ASSERT(runIndex(log, 0, layer - 1) < 
+                    runIndex(log, 0, layer));
+    }
+    for(size_t layer = 0; layer < 10; ++layer) {
+        size_t after = runIndex(log, 1, layer);
+        CPPUNIT_ASSERT(after < log.size());
+        for(int offset = -2; offset <= 2; ++offset) {
+            int other = int(layer) + offset;
+            if(other < 2 || other >= 8)
+                continue;
+            CPPUNIT_ASSERT(runIndex(log, 0, other) < after);
+        }
+    }
+    for(size_t layer = 4; layer < 6; ++layer) {
+        size_t after = runIndex(log, 2, layer);
+        CPPUNIT_ASSERT(after < log.size());
+        for(size_t other = layer; other <= layer + 3; ++other)
+            CPPUNIT_ASSERT(runIndex(log, 1, other) < after);
+    }
+    CPPUNIT_ASSERT(runIndex(log, 0, 2) < runIndex(log, 2, 5));
+
+#ifndef OMPFF
+    //one at a time the oldest ready task goes first: first's layer 2 
+    //frees its layer 3 ahead of second's layer 0, and third's top layer, 
+    //which waits for second up to layer 8, is the last to go
+    CPPUNIT_ASSERT(log[0] == make_pair(0, (size_t)2));
+    CPPUNIT_ASSERT(log[1] == make_pair(0, (size_t)3));
+    CPPUNIT_ASSERT(log[2] == make_pair(1, (size_t)0));
+    CPPUNIT_ASSERT(log.back() == make_pair(2, (size_t)5));
+#endif
+
+    //the tasks are forgotten, the stages are not
+    log.clear();
+    scheduler.run();
+    CPPUNIT_ASSERT_EQUAL((size_t)18, log.size());
+}
+
+void LayerSchedulerTestCase::testCycle() {
+    RunLog log;
+    RecordingStage first(0, log);
+    RecordingStage second(1, log);
+    LayerScheduler scheduler;
+    LayerScheduler::stage_id a = scheduler.addStage(first, 0, 4);
+    LayerScheduler::stage_id b = scheduler.addStage(second, 0, 4);
+    scheduler.addDependency(b, a, 0, 0);
+    //layer 3 of first waits for layer 1 of second, which waits on layer 1 
+    //of first; fine so far
+    scheduler.addDependency(a, b, -2, -2);
+    scheduler.run();
+    CPPUNIT_ASSERT_EQUAL((size_t)8, log.size());
+
+    //now layer 1 of first also waits for layer 3 of second
+    log.clear();
+    scheduler.addDependency(a, b, 2, 2);
+    CPPUNIT_ASSERT_THROW(scheduler.run(), mgl::Exception);
+    CPPUNIT_ASSERT(log.empty());
+
+    //a stage waiting on itself never starts
+    RecordingStage third(2, log);
+    LayerScheduler selfish;
+    LayerScheduler::stage_id c = selfish.addStage(third, 0, 3);
+    selfish.addDependency(c, c, 0, 0);
+    CPPUNIT_ASSERT_THROW(selfish.run(), mgl::Exception);
+    CPPUNIT_ASSERT(log.empty());
+
+    CPPUNIT_ASSERT_THROW(selfish.addDependency(c, c + 1, 0, 0), 
+            mgl::Exception);
+}
+
+void LayerSchedulerTestCase::testEmpty() {
+    LayerScheduler scheduler;
+    CountingListener listener;
+    scheduler.setListener(&listener);
+    CPPUNIT_ASSERT_EQUAL((size_t)0, scheduler.taskCount());
+    scheduler.run();
+    CPPUNIT_ASSERT_EQUAL((size_t)0, listener.count);
+
+    //stages over no layers add no tasks, and depending on them is a no-op
+    RunLog log;
+    RecordingStage first(0, log);
+    RecordingStage second(1, log);
+    LayerScheduler::stage_id a = scheduler.addStage(first, 3, 3);
+    LayerScheduler::stage_id b = scheduler.addStage(second, 5, 2);
+    scheduler.addDependency(a, b, -1, 1);
+    scheduler.addDependency(b, a, -1, 1);
+    CPPUNIT_ASSERT_EQUAL((size_t)0, scheduler.taskCount());
+    scheduler.run();
+    CPPUNIT_ASSERT(log.empty());
+    CPPUNIT_ASSERT_EQUAL((size_t)0, listener.count);
+}
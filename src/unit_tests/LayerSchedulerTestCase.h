@@ -0,0 +1,26 @@
+/* 
+ * File:   LayerSchedulerTestCase.h
+ * Author: Dev
+ */
+
+#ifndef LAYERSCHEDULERTESTCASE_H
+#define	LAYERSCHEDULERTESTCASE_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class LayerSchedulerTestCase : public CPPUNIT_NS::TestFixture {
+private:
+    CPPUNIT_TEST_SUITE( LayerSchedulerTestCase );
+    CPPUNIT_TEST( testNeighbourOrder );
+    CPPUNIT_TEST( testCycle );
+    CPPUNIT_TEST( testEmpty );
+    CPPUNIT_TEST_SUITE_END();
+public:
+    void setUp();
+protected:
+    void testNeighbourOrder(); //dependencies on nearby layers run first
+    void testCycle(); //a graph that cannot finish throws
+    void testEmpty(); //nothing to run
+};
+
+#endif	/* LAYERSCHEDULERTESTCASE_H */
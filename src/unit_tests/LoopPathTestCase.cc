@@ -6,10 +6,15 @@
 #include "mgl/loop_path.h"
 #include "mgl/insets.h"
 #include "mgl/loop_utils.h"
+#include "mgl/configuration.h"
+#include "mgl/meshy.h"
+#include "mgl/slicer.h"
 
 #include <iostream>
 #include <sstream>
 #include <list>
+#include <limits>
+#include <algorithm>
 
 using namespace std;
 using namespace mgl;
@@ -535,6 +540,161 @@ void LoopPathTestCase::testConvex() {
 	}
 }
 
+/// the gift wrapping createConvexLoop used before its monotone chain
+static void giftWrapHull(std::vector<Point2Type> points, 
+		std::vector<Point2Type>& hull) {
+	stripDuplicates(points, AxisFunctor());
+	std::sort(points.begin(), points.end(), AxisFunctor(Y_AXIS));
+	std::vector<Point2Type>::iterator startIter = points.begin();
+	std::vector<Point2Type>::iterator lastIter = points.begin();
+	hull.push_back(*lastIter);
+	do {
+		std::vector<Point2Type>::iterator bestIter = lastIter;
+		++bestIter;
+		if(bestIter == points.end())
+			bestIter = points.begin();
+		for(std::vector<Point2Type>::iterator iter = points.begin(); 
+				iter != points.end(); 
+				++iter ){
+			if(AngleFunctor(*lastIter).operator ()(
+					*bestIter, *iter)) {
+				bestIter = iter;
+			}
+		}
+		lastIter = bestIter;
+		hull.push_back(*lastIter);
+	} while(lastIter != startIter);
+}
+
+/// distance from @a point to the closed polyline @a hull
+static Scalar distanceToHull(const Point2Type& point, 
+		const std::vector<Point2Type>& hull) {
+	Scalar best = std::numeric_limits<Scalar>::max();
+	for(size_t i = 0; i + 1 < hull.size(); ++i) {
+		Point2Type edge = hull[i + 1] - hull[i];
+		Scalar along = edge.squaredMagnitude() > 0 ? 
+				(point - hull[i]).dotProduct(edge) / 
+				edge.squaredMagnitude() : 0;
+		along = std::max(Scalar(0), std::min(Scalar(1), along));
+		best = std::min(best, 
+				(point - (hull[i] + edge * along)).magnitude());
+	}
+	return best;
+}
+
+void LoopPathTestCase::testOrientation() {
+	CPPUNIT_ASSERT_EQUAL(1, orientation(Point2Type(0,0), 
+			Point2Type(1,0), Point2Type(0,1)));
+	CPPUNIT_ASSERT_EQUAL(-1, orientation(Point2Type(0,0), 
+			Point2Type(0,1), Point2Type(1,0)));
+	CPPUNIT_ASSERT_EQUAL(0, orientation(Point2Type(0,0), 
+			Point2Type(1,1), Point2Type(3,3)));
+	//one unit in the last place off a line, where rounding decides a 
+	//plain cross product
+	Scalar above = 0.5 + std::numeric_limits<Scalar>::epsilon() / 2;
+	CPPUNIT_ASSERT_EQUAL(1, orientation(Point2Type(12,12), 
+			Point2Type(24,24), Point2Type(0.5,above)));
+	CPPUNIT_ASSERT_EQUAL(-1, orientation(Point2Type(24,24), 
+			Point2Type(12,12), Point2Type(0.5,above)));
+	//near collinear points give the same answer in any order
+	for(int i = 1; i < 200; ++i) {
+		Point2Type a(0.1 * i, 0.3 * i);
+		Point2Type b(0.7 + 0.1 * i, 2.1 + 0.3 * i);
+		Point2Type c(1.9 - 0.3 * i, 5.7 - 0.9 * i);
+		int turn = orientation(a, b, c);
+		CPPUNIT_ASSERT_EQUAL(turn, orientation(b, c, a));
+		CPPUNIT_ASSERT_EQUAL(turn, orientation(c, a, b));
+		CPPUNIT_ASSERT_EQUAL(-turn, orientation(b, a, c));
+		CPPUNIT_ASSERT_EQUAL(-turn, orientation(a, c, b));
+	}
+}
+
+void LoopPathTestCase::testConvexModels() {
+	MyComputer computer;
+	char pathsep = computer.fileSystem.getPathSeparatorCharacter();
+	std::string inputsDir = std::string("inputs") + pathsep;
+	const char* models[] = { "20mm_Calibration_Box.stl", "3D_Knot.stl", 
+			"hexagon.stl", "holy_cube.stl" };
+	
+	Configuration config;
+	config.readFromFile("miracle.config");
+	GrueConfig grueCfg;
+	grueCfg.loadFromFile(config);
+	
+	for(size_t model = 0; model < sizeof(models) / sizeof(*models); ++model) {
+		cout << endl << "Convex hulls of " << models[model] << endl;
+		Meshy mesh(grueCfg);
+		mesh.readStlFile((inputsDir + models[model]).c_str());
+		Segmenter segmenter(grueCfg);
+		segmenter.tablaturize(mesh);
+		Slicer slicer(grueCfg);
+		LayerLoops layerloops(grueCfg.get_firstLayerZ(), 
+				grueCfg.get_layerH());
+		slicer.generateLoops(segmenter, layerloops);
+		CPPUNIT_ASSERT(!layerloops.empty());
+		
+		bool firstLayer = true;
+		for(LayerLoops::const_layer_iterator layer = layerloops.begin(); 
+				layer != layerloops.end(); 
+				++layer) {
+			if(layer->empty())
+				continue;
+			LoopList loops(layer->begin(), layer->end());
+			std::vector<Point2Type> points;
+			for(LoopList::const_iterator loop = loops.begin(); 
+					loop != loops.end(); 
+					++loop) {
+				for(Loop::const_finite_cw_iterator iter = 
+						loop->clockwiseFinite(); 
+						iter != loop->clockwiseEnd(); 
+						++iter)
+					points.push_back(*iter);
+			}
+			Loop convexLoop = createConvexLoop(loops);
+			std::vector<Point2Type> hull;
+			for(Loop::finite_cw_iterator iter = convexLoop.clockwiseFinite(); 
+					iter != convexLoop.clockwiseEnd(); 
+					++iter)
+				hull.push_back(*iter);
+			
+			//closed, clockwise from the lowest then leftmost point
+			CPPUNIT_ASSERT(hull.size() >= 4);
+			CPPUNIT_ASSERT_EQUAL(hull.front(), hull.back());
+			CPPUNIT_ASSERT_EQUAL(*std::min_element(points.begin(), 
+					points.end(), AxisFunctor(Y_AXIS)), hull.front());
+			for(size_t i = 0; i + 1 < hull.size(); ++i) {
+				const Point2Type& next = hull[i + 2 < hull.size() ? 
+						i + 2 : 1];
+				CPPUNIT_ASSERT_EQUAL(-1, orientation(hull[i], hull[i + 1], 
+						next));
+			}
+			//holding every point
+			for(std::vector<Point2Type>::const_iterator point = 
+					points.begin(); 
+					point != points.end(); 
+					++point) {
+				for(size_t i = 0; i + 1 < hull.size(); ++i)
+					CPPUNIT_ASSERT(orientation(hull[i], hull[i + 1], 
+							*point) <= 0);
+			}
+			
+			//rafts take the hull of the first layer. There the gift 
+			//wrapping gives the same hull, but for collinear points and 
+			//points within rounding of an edge, which it may keep or drop
+			if(firstLayer) {
+				std::vector<Point2Type> wrapped;
+				giftWrapHull(points, wrapped);
+				CPPUNIT_ASSERT_EQUAL(wrapped.front(), hull.front());
+				for(size_t i = 0; i < wrapped.size(); ++i)
+					CPPUNIT_ASSERT(distanceToHull(wrapped[i], hull) < 1e-9);
+				for(size_t i = 0; i < hull.size(); ++i)
+					CPPUNIT_ASSERT(distanceToHull(hull[i], wrapped) < 1e-9);
+				firstLayer = false;
+			}
+		}
+	}
+}
+
 void LoopPathTestCase::testDegenerateSmoothing() {
     Scalar weight = 0.5;
     Scalar coarseness = 0.05;
@@ -559,4 +719,74 @@ void LoopPathTestCase::testDegenerateSmoothing() {
     }
 }
 
+static Scalar distanceToSegment(const Point2Type& point, 
+        const Point2Type& a, const Point2Type& b) {
+    Point2Type delta = b - a;
+    Scalar t = (point - a).dotProduct(delta) / delta.squaredMagnitude();
+    t = std::max(Scalar(0), std::min(Scalar(1), t));
+    return (point - (a + delta * t)).magnitude();
+}
 
+void LoopPathTestCase::testSimplify() {
+    Scalar tolerance = 0.05;
+    //a wavy circle, finely divided
+    vector<Point2Type> points;
+    for(int i = 0; i < 500; ++i) {
+        Scalar angle = i * 2 * M_PI / 500;
+        Scalar radius = 10 + 0.02 * sin(angle * 40);
+        points.push_back(Point2Type(radius * cos(angle), 
+                radius * sin(angle)));
+    }
+    Loop loop;
+    OpenPath path;
+    for(vector<Point2Type>::const_iterator iter = points.begin(); 
+            iter != points.end(); 
+            ++iter) {
+        loop.insertPointBefore(*iter, loop.clockwiseEnd());
+        path.appendPoint(*iter);
+    }
+    
+    simplify(loop, tolerance);
+    simplify(path, tolerance);
+    CPPUNIT_ASSERT(loop.size() >= 3 && loop.size() < points.size() / 2);
+    CPPUNIT_ASSERT(path.size() >= 2 && path.size() < points.size() / 2);
+    CPPUNIT_ASSERT_EQUAL(points.front(), *path.fromStart());
+    CPPUNIT_ASSERT_EQUAL(points.back(), *path.fromEnd());
+    
+    //every original point stays within tolerance of the simplified shapes
+    vector<Point2Type> loopPoints, pathPoints;
+    for(Loop::finite_cw_iterator iter = loop.clockwiseFinite(); 
+            iter != loop.clockwiseEnd(); 
+            ++iter) {
+        loopPoints.push_back(*iter);
+    }
+    for(OpenPath::iterator iter = path.fromStart(); 
+            iter != path.end(); 
+            ++iter) {
+        pathPoints.push_back(*iter);
+    }
+    for(vector<Point2Type>::const_iterator iter = points.begin(); 
+            iter != points.end(); 
+            ++iter) {
+        Scalar loopDistance = 1e10;
+        for(size_t i = 0; i < loopPoints.size(); ++i) {
+            loopDistance = std::min(loopDistance, distanceToSegment(*iter, 
+                    loopPoints[i], loopPoints[(i + 1) % loopPoints.size()]));
+        }
+        Scalar pathDistance = 1e10;
+        for(size_t i = 0; i + 1 < pathPoints.size(); ++i) {
+            pathDistance = std::min(pathDistance, distanceToSegment(*iter, 
+                    pathPoints[i], pathPoints[i + 1]));
+        }
+        CPPUNIT_ASSERT(loopDistance <= tolerance + 1e-9);
+        CPPUNIT_ASSERT(pathDistance <= tolerance + 1e-9);
+    }
+    
+    //small loops are left alone
+    Loop triangle;
+    triangle.insertPointBefore(Point2Type(0, 0), triangle.clockwiseEnd());
+    triangle.insertPointBefore(Point2Type(0.01, 0), triangle.clockwiseEnd());
+    triangle.insertPointBefore(Point2Type(0, 0.01), triangle.clockwiseEnd());
+    simplify(triangle, tolerance);
+    CPPUNIT_ASSERT_EQUAL(size_t(3), triangle.size());
+}
@@ -17,7 +17,10 @@ class LoopPathTestCase : public CPPUNIT_NS::TestFixture{
 	CPPUNIT_TEST( testConstLoopPath );
 	CPPUNIT_TEST( testFiniteSegment );
 	CPPUNIT_TEST( testConvex );
+	CPPUNIT_TEST( testOrientation );
+	CPPUNIT_TEST( testConvexModels );
     CPPUNIT_TEST( testDegenerateSmoothing );
+    CPPUNIT_TEST( testSimplify );
 	
 	CPPUNIT_TEST_SUITE_END();
 	
@@ -34,7 +37,10 @@ protected:
 	void testConstLoopPath();
 	void testFiniteSegment();
 	void testConvex();
+	void testOrientation();
+	void testConvexModels();
     void testDegenerateSmoothing();
+    void testSimplify();
 };
 
 
@@ -0,0 +1,96 @@
+#include <cppunit/config/SourcePrefix.h>
+#include <vector>
+#include <cstdlib>
+#include "UnitTestUtils.h"
+#include "PackedRtreeTestCase.h"
+
+#include "mgl/intersection_index.h"
+#include "mgl/basic_boxlist.h"
+#include "mgl/basic_packed_rtree.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION( PackedRtreeTestCase );
+
+using namespace mgl;
+
+void PackedRtreeTestCase::setUp() {
+    //nothing
+    std::cout << "\nNo Setup" << std::endl;
+}
+
+static Segment2Type randomSegment(Scalar range, Scalar range2) {
+    Point2Type a(range * rand() / RAND_MAX, range * rand() / RAND_MAX);
+    Point2Type b(range2 * rand() / RAND_MAX - 0.5 * range2, 
+            range2 * rand() / RAND_MAX - 0.5 * range2);
+    return Segment2Type(a, a + b);
+}
+
+void PackedRtreeTestCase::testFilter() {
+    srand(0);
+    typedef std::vector<Segment2Type> vector;
+    basic_boxlist<Segment2Type> boxlist;
+    basic_packed_rtree<Segment2Type> packed;
+    Scalar range = 200;
+    Scalar range2 = 20;
+    vector dataset;
+    for(size_t i=0; i < 5000; ++i)
+        dataset.push_back(randomSegment(range, range2));
+    //insert most up front, then the rest between searches
+    for(size_t i=0; i < 4000; ++i) {
+        boxlist.insert(dataset[i]);
+        packed.insert(dataset[i]);
+    }
+    for(size_t i=4000; i < dataset.size(); ++i) {
+        Segment2Type testLine = randomSegment(range, range2);
+        vector boxResult;
+        vector packedResult;
+        boxlist.search(boxResult, LineSegmentFilter(testLine));
+        packed.search(packedResult, LineSegmentFilter(testLine));
+        //the packed tree may leave out boxes the line misses
+        vector boxHits;
+        vector packedHits;
+        for(vector::const_iterator iter = boxResult.begin(); 
+                iter != boxResult.end(); 
+                ++iter) {
+            if(testLine.intersects(*iter))
+                boxHits.push_back(*iter);
+        }
+        for(vector::const_iterator iter = packedResult.begin(); 
+                iter != packedResult.end(); 
+                ++iter) {
+            if(testLine.intersects(*iter))
+                packedHits.push_back(*iter);
+        }
+        //same hits in insertion order
+        CPPUNIT_ASSERT_EQUAL(boxHits.size(), packedHits.size());
+        for(size_t hit = 0; hit < boxHits.size(); ++hit) {
+            CPPUNIT_ASSERT(boxHits[hit].a == packedHits[hit].a);
+            CPPUNIT_ASSERT(boxHits[hit].b == packedHits[hit].b);
+        }
+        boxlist.insert(dataset[i]);
+        packed.insert(dataset[i]);
+    }
+    
+    //near searches find everything touching the grown box
+    AABBox around(Point2Type(90, 90), Point2Type(110, 110));
+    vector near;
+    packed.searchNear(near, around, 5);
+    size_t expected = 0;
+    AABBox grown = around.adjusted(Point2Type(-5, -5), Point2Type(5, 5));
+    for(vector::const_iterator iter = dataset.begin(); 
+            iter != dataset.end(); 
+            ++iter) {
+        if(grown.intersects(to_bbox<Segment2Type>::bound(*iter)))
+            ++expected;
+    }
+    CPPUNIT_ASSERT_EQUAL(expected, near.size());
+    
+    //erased values are not found again
+    Segment2Type gone = dataset[10];
+    CPPUNIT_ASSERT_EQUAL(size_t(1), packed.erase(gone));
+    vector after;
+    packed.search(after, BBoxFilter(to_bbox<Segment2Type>::bound(gone)));
+    for(vector::const_iterator iter = after.begin(); 
+            iter != after.end(); 
+            ++iter)
+        CPPUNIT_ASSERT(!(iter->a == gone.a && iter->b == gone.b));
+}
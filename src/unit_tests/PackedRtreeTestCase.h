@@ -0,0 +1,22 @@
+/* 
+ * File:   PackedRtreeTestCase.h
+ * Author: Dev
+ */
+
+#ifndef PACKEDRTREETESTCASE_H
+#define	PACKEDRTREETESTCASE_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class PackedRtreeTestCase : public CPPUNIT_NS::TestFixture {
+private:
+    CPPUNIT_TEST_SUITE( PackedRtreeTestCase );
+    CPPUNIT_TEST( testFilter );
+    CPPUNIT_TEST_SUITE_END();
+public:
+    void setUp();
+protected:
+    void testFilter(); //packed rtree against boxlist
+};
+
+#endif	/* PACKEDRTREETESTCASE_H */